@@ -0,0 +1,63 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Vector>
+
+namespace geometry {
+
+/*!
+ * \brief The BoundingBox class represents an axis aligned box.
+ *
+ * It is used to bound groups of mesh entities, so spatial queries can discard
+ * all of them at once by testing only the box.
+ */
+class BoundingBox {
+public:
+
+	/// Constructs an empty box. Extending it with a point gives a box containing only that point.
+	BoundingBox();
+
+	/// Constructs a box given its lower and upper corners.
+	BoundingBox(const math::Vector3& min, const math::Vector3& max);
+
+	/// The corner with the lowest coordinates.
+	const math::Vector3& min() const;
+
+	/// The corner with the highest coordinates.
+	const math::Vector3& max() const;
+
+	/// An empty box contains no points at all.
+	bool isEmpty() const;
+
+	/// Grows the box so that it contains the given point.
+	void extend(const math::Vector3& point);
+
+	/// Grows the box so that it contains the given box.
+	void extend(const BoundingBox& box);
+
+	/// Grows the box by the given margin on every direction.
+	void inflate(math::Real margin);
+
+	/// Checks if a point is inside the box. Points on the boundary are inside.
+	bool contains(const math::Vector3& point) const;
+
+	/// Gets the center of the box.
+	math::Vector3 center() const;
+
+	/// Gets the size of the box along each axis.
+	math::Vector3 extent() const;
+
+	/// Gets the total area of the faces of the box. Empty boxes have no area.
+	math::Real area() const;
+
+	/// Gets the index of the axis along which the box is the longest.
+	unsigned largestAxis() const;
+
+private:
+
+	math::Vector3 _min;
+	math::Vector3 _max;
+
+};
+
+} // namespace geometry
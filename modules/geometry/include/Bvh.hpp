@@ -0,0 +1,108 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <geometry/Mesh>
+#include <geometry/Vertex>
+#include <geometry/Triangle>
+#include <geometry/PackedTriangle>
+#include <geometry/BoundingBox>
+#include <math/ThreadPool>
+
+namespace geometry {
+
+/*!
+ * \brief The Bvh class is a bounding volume hierarchy built over the triangles of a Mesh.
+ *
+ * The hierarchy is a binary tree of boxes. Each leaf holds a few triangles and each inner node bounds its two children,
+ * so a Ray can skip a whole branch by missing its box. The tree is built top-down, splitting every node where the
+ * surface area heuristic (SAH) predicts the cheapest traversal.
+ *
+ * Big meshes can be built on the threads of a math::ThreadPool. Each thread takes a whole subtree, and the top nodes,
+ * which are too few to share that way, split their own binning and partitioning work between threads. The resulting
+ * tree does not depend on the number of threads, only the order in which its nodes are stored does.
+ *
+ * A Bvh references the triangles of the Mesh it was built from, it does not copy them. It must not outlive that Mesh.
+ * Adding triangles to the Mesh makes the Bvh stale, it has to be built again. Moving vertices, as Mesh::apply() and
+ * Solid::centralize() do, only makes the boxes stale. Those are fixed by refit(), which keeps the tree as it is.
+ * When only a few vertices move, touch() them and call refitTouched() to update only the affected branches.
+ */
+class Bvh {
+public:
+
+	/// \brief A node of the tree.
+	///
+	/// Leaves have a non-zero count and hold the triangles [first, first+count) of triangles().
+	/// Inner nodes have a zero count and their children are the nodes first and first+1.
+	struct Node {
+		BoundingBox box;
+		unsigned first;
+		unsigned count;
+
+		bool isLeaf() const { return count > 0; }
+	};
+
+	/// Chooses between a faster build and a faster tree.
+	enum class Quality {
+		/// Evaluates splits on a fixed number of bins per axis. Complexity: O(n log n)
+		Fast,
+
+		/// Evaluates every possible split, sorting the triangles along each axis. Complexity: O(n log² n)
+		High
+	};
+
+	/// The tree is never deeper than this, so traversals can use a fixed size stack.
+	static constexpr unsigned maxDepth = 64;
+
+	/// \brief Builds the hierarchy over all triangles of the mesh.
+	///
+	/// When a pool is given, the build is split between its threads.
+	explicit Bvh(const Mesh& mesh, Quality quality = Quality::High, math::ThreadPool* pool = nullptr);
+
+	/// Returns the nodes of the tree. The root is the first one.
+	const std::vector<Node>& nodes() const;
+
+	/// \brief Returns the triangles of the mesh, ordered such that each leaf references a contiguous range.
+	///
+	/// The position of a triangle in this collection is its id on the hits of casts on this Bvh.
+	const std::vector<Triangle>& triangles() const;
+
+	/// Returns the vertex positions of each triangle, in the same order as triangles(). Casts read them from here.
+	const std::vector<PackedTriangle>& packedTriangles() const;
+
+	/// Returns the box bounding the whole mesh.
+	const BoundingBox& bounds() const;
+
+	/// An empty Bvh was built from a Mesh without triangles. It has no nodes.
+	bool isEmpty() const;
+
+	/// \brief Updates all boxes to the current vertex positions. Complexity: O(n)
+	///
+	/// The tree topology is kept, so its quality slowly degrades if the mesh deforms a lot. Rebuild it when that happens.
+	void refit();
+
+	/// Marks the branches holding triangles of this vertex to be updated by refitTouched(). Complexity: O(log n)
+	void touch(const Vertex& vertex);
+
+	/// Marks the branch holding this triangle to be updated by refitTouched(). Complexity: O(log n)
+	void touch(const Triangle& triangle);
+
+	/// Updates the boxes of the touched branches only. Complexity: O(k log k), where k is the number of nodes to update
+	void refitTouched();
+
+private:
+
+	void refitNode(unsigned node);
+
+	std::vector<Node> _nodes;             //!< The tree, root first. Siblings are always stored side by side.
+	std::vector<Triangle> _triangles;     //!< The triangles in leaf order.
+	std::vector<PackedTriangle> _packed;  //!< The vertex positions of _triangles, updated on refits.
+	std::vector<unsigned> _parents;       //!< The parent of each node. Parents are always stored before their children.
+	std::map<Triangle, unsigned> _leaves; //!< The leaf holding each triangle. Only filled once something is touched.
+	std::vector<unsigned> _touched;       //!< Nodes to be updated by refitTouched().
+	std::vector<bool> _isTouched;         //!< Whether each node is already in _touched.
+
+};
+
+} // namespace geometry
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <geometry/TriangleHit>
+
+namespace geometry {
+
+/*!
+ * \brief The HitBuffer class collects the hits of a cast as plain TriangleHit records.
+ *
+ * Unlike RayHitSet, adding a hit allocates nothing once the buffer has grown to its working size, and hits don't
+ * carry a copy of their Ray. Keep a buffer around and pass it to every cast: each cast clears it, keeping its memory.
+ */
+class HitBuffer {
+public:
+
+	using const_iterator = std::vector<TriangleHit>::const_iterator;
+
+	/// Removes all hits, keeping the memory for the next cast.
+	void clear();
+
+	/// Appends a hit, in any order.
+	void add(const TriangleHit& hit);
+
+	/// \brief Sorts the hits by distance and removes duplicates, in a single pass after sorting.
+	///
+	/// The hits kept are the ones RayHitSet::removeDuplicates() keeps: a hit is dropped when the next one is closer
+	/// than RayHitSet::duplicateDistance to it. Hits at the same distance are ordered by triangle id, so the result
+	/// doesn't depend on the order the hits were added in.
+	void finish();
+
+	std::size_t size() const;
+	bool empty() const;
+	const TriangleHit& operator[](std::size_t i) const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+
+	std::vector<TriangleHit> _hits;
+
+};
+
+} // namespace geometry
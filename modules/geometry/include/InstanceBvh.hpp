@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include <geometry/Bvh>
+#include <geometry/BoundingBox>
+#include <geometry/Transform>
+
+namespace geometry {
+
+/*!
+ * \brief The InstanceBvh class is a bounding volume hierarchy over placed copies of meshes.
+ *
+ * Each instance is a reference to the Bvh of a mesh plus the Transform placing it in the world. Many instances can
+ * share the same Bvh, so a mesh used by hundreds of drones is stored, and its Bvh built, only once.
+ *
+ * Rays are cast on the top level tree, built over the boxes of the instances. When a ray reaches an instance it is
+ * moved into the space of its mesh by the inverse transform and cast on the shared Bvh, the bottom level tree.
+ *
+ * After instances are added, or moved with move(), call update() before casting rays on it again.
+ * The referenced Bvhs must outlive the InstanceBvh.
+ */
+class InstanceBvh {
+public:
+
+	/// Constructs an InstanceBvh with no instances.
+	InstanceBvh();
+
+	/// \brief Adds an instance of the mesh the Bvh was built from, placed by the transform.
+	///
+	/// Returns the id of the new instance. Ids are given in sequence, starting from zero.
+	/// Throws if the transform is not invertible.
+	unsigned add(const Bvh& bvh, const Transform& transform);
+
+	/// \brief Places an instance with a new transform. Complexity: O(1)
+	///
+	/// Throws if the transform is not invertible.
+	void move(unsigned instance, const Transform& transform);
+
+	/// \brief Makes the top level tree match the instances. Complexity: O(m) after moves, O(m log² m) after additions.
+	///
+	/// m is the number of instances. Added instances require building the tree again, moved ones only refitting it.
+	void update();
+
+	/// Whether update() has to be called before casting rays.
+	bool needsUpdate() const;
+
+	/// The number of instances.
+	unsigned size() const;
+
+	/// The Bvh referenced by an instance.
+	const Bvh& bvh(unsigned instance) const;
+
+	/// The transform placing an instance.
+	const Transform& transform(unsigned instance) const;
+
+	/// The transform taking world points into the space of an instance.
+	const Transform& inverse(unsigned instance) const;
+
+	/// The nodes of the top level tree. The leaves reference the instances in instances().
+	const std::vector<Bvh::Node>& nodes() const;
+
+	/// The instance ids in top level leaf order.
+	const std::vector<unsigned>& instances() const;
+
+private:
+
+	struct Instance {
+		const Bvh* bvh;
+		Transform transform;
+		Transform inverse;
+		BoundingBox box;
+	};
+
+	void place(Instance& instance, const Transform& transform);
+
+	std::vector<Instance> _instances;
+	std::vector<Bvh::Node> _nodes;   //!< The top level tree, root first.
+	std::vector<unsigned> _order;    //!< The instance ids in leaf order.
+	bool _needsBuild;
+	bool _needsRefit;
+
+};
+
+} // namespace geometry
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <set>
 
 #include <math/Vector>
@@ -27,6 +28,13 @@ namespace geometry {
  * Notice that a Mesh is not required to be closed, manifold, nor connected. It can be seen simply as a set of triangles.
  *
  * A mesh entity is either a Vertex, an Edge or a Triangle.
+ *
+ * In deferred mode, apply() does not move the vertices, it composes the transformation into a pending one. All the
+ * pending transformations are applied in a single pass when vertices(), edges(), triangles() or flush() is called.
+ * Until then, handles kept from before apply() still see the old positions, and a Bvh built on the mesh must not be
+ * refitted. The first of those calls writes the vertices, so it must not race with other calls on the same Mesh.
+ * Ray::castOnMesh() moves the ray instead of the mesh, with the inverse apply() stored, so it leaves the
+ * transformation pending and only reads the mesh. Casts can then run from many threads at once.
  */
 class Mesh {
 public:
@@ -90,10 +98,46 @@ public:
 	/// Refer to the Triangle documentation for details.
 	/// \note This function is exception-safe. If any exception happens, Mesh will remain unchanged.
 	Triangle addTriangle(Edge e1, Edge e2, Edge e3);
+
+	/// \brief Inserts new vertices at points, and triangles given by the indices of three of them, in a single pass.
+	///
+	/// Meant for trusted data such as a StaticMesh. The vertices are all new, so unlike addTriangle() it doesn't look
+	/// for existing triangles, and each triangle keeps the order of its indices, so the orientation of the data is
+	/// kept. Edges shared by triangles are inserted once. The indices must name three different vertices.
+	/// \note If an exception happens, the entities inserted until then stay in the Mesh.
+	void addTriangles(const math::Vector3* points, std::size_t pointCount, const unsigned (*indices)[3], std::size_t triangleCount);
 	
-	/// Applies a transformation in the mesh
+	/// \brief Applies a transformation in the mesh, moving each vertex in place in a single pass.
+	///
+	/// In deferred mode the transformation is only composed into the pending one.
 	void apply(const Transform& transform);
 
+	/// Turns the deferred mode on or off. Turning it off applies the pending transformation.
+	void setDeferred(bool deferred);
+
+	/// Returns whether apply() is deferred.
+	bool deferred() const;
+
+	/// Returns whether the vertices still wait for a transformation.
+	bool hasPending() const;
+
+	/// Returns the transformation the vertices still wait for. It is the identity when there is none.
+	const Transform& pending() const;
+
+	/// Returns whether the pending transformation has an inverse, stored by apply(). False when there is none pending.
+	bool hasPendingInverse() const;
+
+	/// The inverse of pending(), which takes points back to where the vertices still are. Only valid if hasPendingInverse()
+	const Transform& pendingInverse() const;
+
+	/// \brief Returns the triangles without applying the pending transformation.
+	///
+	/// Their vertices are still where they were before it, so pendingInverse() must be applied to what is cast on them.
+	const std::set<Triangle>& unflushedTriangles() const;
+
+	/// Applies the pending transformation, if any, in a single pass over the vertices.
+	void flush() const;
+
 	/// \brief Write all mesh data into a stream.
 	///
 	/// The file format is very similar to Wavefront OBJ, but is not compactible in any way. The format is text based and can
@@ -108,9 +152,18 @@ public:
 
 private:
 
+	/// Inserts the triangle of the given edges and vertices, in that order. Exception-safe
+	Triangle linkTriangle(Edge e1, Edge e2, Edge e3, Vertex v1, Vertex v2, Vertex v3);
+
 	std::set<Vertex> _vertices;      //!< The internal list of vertices. This is required for iteration and destruction.
 	std::set<Edge> _edges;           //!< The internal list of edges. This is required for iteration and destruction.
 	std::set<Triangle> _triangles;   //!< The internal list of triangles. This is required for iteration and destruction.
+
+	mutable Transform _pending;      //!< The transformations the vertices still wait for, in deferred mode.
+	mutable bool _hasPending;
+	Transform _pendingInverse;       //!< The inverse of _pending, computed by apply() so readers never fill a cache.
+	mutable bool _hasPendingInverse;
+	bool _deferred;
 	
 };
 
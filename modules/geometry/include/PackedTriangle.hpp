@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+
+#include <math/Vector>
+#include <geometry/Triangle>
+
+namespace geometry {
+
+/*!
+ * \brief The PackedTriangle struct holds copies of the vertex positions of a triangle.
+ *
+ * Intersection tests on a Triangle have to follow its Vertex handles to reach each position. Storing packed
+ * triangles side by side lets a cast on many triangles read them from contiguous memory instead.
+ * A packed triangle does not follow its vertices, it has to be packed again when they move.
+ */
+struct PackedTriangle {
+
+	PackedTriangle() = default;
+
+	/// Copies the current vertex positions of the triangle.
+	explicit PackedTriangle(const Triangle& triangle);
+
+	std::array<math::Vector3, 3> vertices;
+
+};
+
+} // namespace geometry
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <limits>
+
 #include <geometry/Mesh>
 #include <math/Real>
 
@@ -7,24 +9,108 @@ namespace geometry {
 
 class RayHit;
 class RayHitSet;
+class HitBuffer;
+struct TriangleHit;
+struct PackedTriangle;
+class BoundingBox;
+class Bvh;
+class InstanceBvh;
+template <unsigned W> class RayPacket;
 
 class Ray {
+	template <unsigned W> friend class RayPacket;
 public:
 
-	Ray(math::Vector3 origin, math::Vector3 direction);
+	/// \brief Constructs a ray from origin along direction.
+	///
+	/// Only hits at distances in [tMin, tMax] are reported, so a ray can also stand for a segment. Distances are
+	/// measured in multiples of direction. Whatever the range, nothing behind the origin is ever hit.
+	Ray(math::Vector3 origin, math::Vector3 direction,
+		math::Real tMin = 0, math::Real tMax = std::numeric_limits<math::Real>::infinity());
 
 	RayHit castOnTriangle(Triangle triangle) const;
+
+	/// \brief Intersects the ray with a triangle. This is the test every cast is built on.
+	///
+	/// The test is watertight: edges and vertices belong to the triangle regardless of rounding, so a ray crossing
+	/// an edge shared by triangles hits all of them. Rays parallel to the triangle never hit it. On a hit it fills
+	/// hit, with id as the triangle id, and returns true. It never throws.
+	bool castOnTriangle(const PackedTriangle& triangle, unsigned id, TriangleHit& hit) const;
 	RayHitSet castOnMesh(const Mesh& mesh) const;
 
+	/// \brief Casts the ray on a mesh, writing the hits to a buffer. Complexity: O(n)
+	///
+	/// The buffer is cleared first and ends up finished, holding the hits castOnMesh() would give. Triangle ids
+	/// are positions in the iteration order of Mesh::triangles().
+	void castOnMesh(const Mesh& mesh, HitBuffer& hits) const;
+
+	/// \brief Casts the ray on the mesh a Bvh was built from. Complexity: O(log n) on average
+	///
+	/// The hits are exactly the ones castOnMesh() would give, but only triangles whose boxes the ray crosses are tested.
+	RayHitSet castOnBvh(const Bvh& bvh) const;
+
+	/// \brief Casts the ray on the mesh of a Bvh, writing the hits to a buffer.
+	///
+	/// The buffer is cleared first and ends up finished, holding the hits castOnBvh() would give. Triangle ids
+	/// are positions in Bvh::triangles().
+	void castOnBvh(const Bvh& bvh, HitBuffer& hits) const;
+
+	/// \brief Casts the ray on all instances of an InstanceBvh.
+	///
+	/// The hits are the ones castOnMesh() would give on a single mesh holding a transformed copy of every instance.
+	/// Throws if the InstanceBvh needs an update.
+	RayHitSet castOnInstances(const InstanceBvh& instances) const;
+
+	/// \brief Finds the nearest hit on the mesh of a Bvh.
+	///
+	/// Branches farther than the nearest hit found so far are skipped. The returned hit has no hit if there was none.
+	RayHit castClosest(const Bvh& bvh) const;
+
+	/// Finds the nearest hit on the mesh of a Bvh, like castClosest(), but also tells which triangle was hit.
+	/// Returns false, leaving hit untouched, if there was no hit.
+	bool castClosest(const Bvh& bvh, TriangleHit& hit) const;
+
+	/// Finds the nearest hit on all instances of an InstanceBvh. Throws if the InstanceBvh needs an update.
+	RayHit castClosest(const InstanceBvh& instances) const;
+
+	/// Checks if the ray hits the mesh of a Bvh at all. It stops at the first hit found, which is not always the nearest.
+	bool castAny(const Bvh& bvh) const;
+
+	/// Checks if the ray hits any instance of an InstanceBvh. Throws if the InstanceBvh needs an update.
+	bool castAny(const InstanceBvh& instances) const;
+
+	/// \brief Counts the hits on the mesh of a Bvh.
+	///
+	/// The result is the size castOnBvh() would give, duplicates removed, without building the RayHitSet.
+	/// Nothing is allocated unless the ray has more than 64 hits.
+	unsigned countHits(const Bvh& bvh) const;
+
+	/// \brief Checks if the ray crosses a box.
+	///
+	/// On a hit, near and far are set to the distances where the ray enters and leaves the box,
+	/// clamped to the range of the ray.
+	bool castOnBox(const BoundingBox& box, math::Real& near, math::Real& far) const;
+
 	math::Vector3 origin() const;
 	math::Vector3 direction() const;
+	math::Real tMin() const;
+	math::Real tMax() const;
 
 	bool operator==(const Ray& other) const;
 
 private:
 
+	/// Adds the hits on the mesh of a Bvh to a buffer, without finishing it.
+	void collectHits(const Bvh& bvh, HitBuffer& hits) const;
+
 	math::Vector3 _origin;
 	math::Vector3 _direction;
+	math::Real _tMin;
+	math::Real _tMax;
+
+	// The triangle test works on a space where the ray goes along the z axis. These map the axes to that space.
+	unsigned _kx, _ky, _kz;
+	math::Real _shearX, _shearY, _shearZ;
 
 };
 
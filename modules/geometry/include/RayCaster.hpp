@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+#include <geometry/Ray>
+#include <math/Real>
+#include <math/ThreadPool>
+
+namespace geometry {
+
+class Bvh;
+
+/*!
+ * \brief The RayCaster class casts large batches of rays on a Bvh, spread over a pool of threads.
+ *
+ * Each ray is cast on its own and writes only its own result, so results don't depend on the number of threads.
+ * They are the same a loop calling the matching Ray query would give. The threads are kept between batches,
+ * so keep a RayCaster around instead of making one per batch.
+ */
+class RayCaster {
+public:
+
+	/// What a batch computes for each ray.
+	enum class Query {
+		/// The nearest hit, as Ray::castClosest() finds it.
+		Closest,
+
+		/// Whether there is any hit, as Ray::castAny() tells.
+		Any,
+
+		/// The number of hits, as Ray::countHits() counts them.
+		Count
+	};
+
+	/// The result of a query for one ray. Fields the query doesn't compute are zero.
+	struct Result {
+		bool hit;             //!< Whether the ray hits the mesh. Set by all queries.
+		unsigned count;       //!< The number of hits. Set by Count.
+		math::Real distance;  //!< The distance to the nearest hit. Set by Closest.
+		unsigned triangle;    //!< The position in Bvh::triangles() of the nearest triangle hit. Set by Closest.
+	};
+
+	/// Rays handed to a thread at a time.
+	static constexpr std::size_t grain = 256;
+
+	/// Starts the threads. When threads is zero, all hardware threads are used.
+	explicit RayCaster(unsigned threads = 0);
+
+	/// Returns the number of threads casting each batch.
+	unsigned threads() const;
+
+	/// Casts count rays on the mesh of a Bvh. The result of rays[i] is written to results[i].
+	void cast(const Bvh& bvh, const Ray* rays, std::size_t count, Query query, Result* results);
+
+private:
+
+	math::ThreadPool _pool;
+
+};
+
+} // namespace geometry
@@ -2,13 +2,25 @@
 
 #include <geometry/Ray>
 #include <math/Vector>
+#include <limits>
 
 namespace geometry {
 
 class RayHit {
 	friend class Ray;
+	friend class RayHitSet;
+	template <unsigned W> friend class RayPacket;
 public:
 
+	/// Hits closer than this to the origin of the ray are ignored, so rays cast from a surface don't hit it.
+	static constexpr math::Real minimumDistance = 0.000001;
+
+	/// \brief Relative tolerance on the signed edge areas of the ray/triangle tests.
+	///
+	/// A ray exactly on an edge gives a zero area, which rounding turns into either sign. The tolerance is well above
+	/// that rounding error at the precision of Real, so edges and vertices always count as part of the triangle.
+	static constexpr math::Real edgeTolerance = 1024 * std::numeric_limits<math::Real>::epsilon();
+
 	math::Real distance() const;
 	bool hasHit() const;
 	math::Vector3 point() const;
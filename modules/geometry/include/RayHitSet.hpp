@@ -1,15 +1,52 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #include <geometry/RayHit>
-#include <set>
 
 namespace geometry {
 
-class RayHitSet : public std::set<RayHit> {
+class HitBuffer;
+
+/*!
+ * \brief The RayHitSet class holds the hits of a Ray, sorted by distance.
+ *
+ * Hits are kept side by side in a single array, so a set costs one allocation rather than one per hit. Casts that
+ * run often should use a HitBuffer instead, which is reused between casts and doesn't copy the Ray into each hit.
+ */
+class RayHitSet {
 public:
 
+	using const_iterator = std::vector<RayHit>::const_iterator;
+	using iterator = const_iterator;
+
+	/// Hits closer than this to each other are considered the same.
+	static constexpr math::Real duplicateDistance = 0.000001;
+
+	RayHitSet() = default;
+
+	/// Holds the hits of a finished buffer as hits of ray.
+	RayHitSet(const Ray& ray, const HitBuffer& hits);
+
+	/// \brief Adds a hit, unless there is one at the same distance already. Complexity: O(n)
+	///
+	/// Returns whether the hit was added. Throws if the hit is from another Ray than the hits already in the set.
+	bool insert(const RayHit& hit);
+
+	/// Removes every hit closer than duplicateDistance to the next one. Complexity: O(n)
 	void removeDuplicates();
 
+	std::size_t size() const;
+	bool empty() const;
+
+	const_iterator begin() const;
+	const_iterator end() const;
+
+private:
+
+	std::vector<RayHit> _hits;
+
 };
 
 } // namespace geometry
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <geometry/Ray>
+#include <geometry/RayHitSet>
+#include <geometry/HitBuffer>
+#include <geometry/TriangleHit>
+#include <math/Real>
+#include <math/Simd>
+
+namespace geometry {
+
+struct PackedTriangle;
+class BoundingBox;
+class Bvh;
+
+/*!
+ * \brief The RayPacket class casts W rays at once, one per SIMD lane.
+ *
+ * A packet traverses a Bvh once for all its rays: a node is visited if any of them crosses its box, and the tests
+ * on boxes and triangles run on all lanes together. This pays off for bundles of rays with similar origins and
+ * directions, which mostly visit the same nodes. Rays going apart just leave lanes idle.
+ *
+ * Every lane gives exactly the hits its Ray gives on its own: the tests do the same floating point operations in
+ * the same order as Ray::castOnBox() and Ray::castOnTriangle().
+ *
+ * Lanes are selected by masks, with bit i standing for lane i. A packet may hold fewer than W rays, the remaining
+ * lanes are never active. RayPacket<4> and RayPacket<8> are available.
+ */
+template <unsigned W>
+class RayPacket {
+	static_assert(W % math::simd::width == 0, "the packet must fill whole SIMD registers");
+	static_assert(W <= 32, "lane masks have 32 bits");
+public:
+
+	static constexpr unsigned width = W;
+
+	/// Copies count rays, which can't be more than W. Throws otherwise.
+	RayPacket(const Ray* rays, unsigned count);
+
+	/// Returns the number of rays in the packet.
+	unsigned size() const;
+
+	/// Returns the ray cast by a lane.
+	const Ray& ray(unsigned lane) const;
+
+	/// Returns the mask of the lanes holding rays.
+	unsigned active() const;
+
+	/// Returns the mask of the lanes in mask whose ray crosses the box, like Ray::castOnBox() would.
+	unsigned castOnBox(const BoundingBox& box, unsigned mask) const;
+
+	/// \brief Intersects the rays of the lanes in mask with a triangle, like Ray::castOnTriangle() would.
+	///
+	/// Returns the mask of the lanes that hit it. Only their entries of hits are written.
+	unsigned castOnTriangle(const PackedTriangle& triangle, unsigned id, unsigned mask, std::array<TriangleHit, W>& hits) const;
+
+	/// Casts every ray on the mesh of a Bvh. Each lane gets the hits Ray::castOnBvh() would give.
+	std::array<RayHitSet, W> castOnBvh(const Bvh& bvh) const;
+
+	/// Casts every ray on the mesh of a Bvh. Each lane gets the hits Ray::castOnBvh() would write to its buffer.
+	void castOnBvh(const Bvh& bvh, std::array<HitBuffer, W>& hits) const;
+
+private:
+
+	using Lanes = std::array<math::Real, W>;
+
+	std::vector<Ray> _rays;
+	unsigned _active;
+	unsigned _degenerate;  //!< Lanes whose ray has a zero direction, so they never hit a triangle.
+
+	std::array<Lanes, 3> _origin;
+	std::array<Lanes, 3> _direction;
+	std::array<Lanes, 3> _inverse;
+	Lanes _near;           //!< Where boxes start to count, the start of the ray range but never behind the origin.
+	Lanes _tMin;
+	Lanes _tMax;
+
+	// The axes and shear of Ray::castOnTriangle(), per lane. When all lanes share the same axes, uniform is set.
+	std::array<std::array<unsigned, W>, 3> _axes;
+	std::array<Lanes, 3> _shear;
+	std::array<Lanes, 3> _sheared;  //!< The origin along the axes of each lane.
+	bool _uniform;
+
+};
+
+} // namespace geometry
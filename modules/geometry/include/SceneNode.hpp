@@ -0,0 +1,75 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <geometry/Transform>
+
+namespace geometry {
+
+/*!
+ * \brief The SceneNode class places parts relative to each other, such as the rotors and turret of a drone body.
+ *
+ * Each node holds a local Transform, relative to its parent, and owns its children. The world transform of a node,
+ * its local one after those of all its ancestors, is computed when asked for and cached. Changing a local transform
+ * only marks the cache of that node and of its descendants as dirty, and a subtree already dirty is not walked again,
+ * so moving a few parts costs only the transforms below them.
+ *
+ * Reading world() on a dirty node writes its cache and the ones of its dirty ancestors, and the first inverse of a world
+ * transform writes the cache of that Transform, so neither must race with other calls on the same tree. update() fills
+ * both caches on the whole subtree, after which world() and the inverses of its transforms only read, from any number
+ * of threads, until the next setLocal().
+ */
+class SceneNode {
+public:
+
+	/// Constructs a root node, placed by transform.
+	explicit SceneNode(const Transform& local = Transform());
+
+	/// Nodes own their children, so they can't be copied.
+	SceneNode(const SceneNode&) = delete;
+	SceneNode& operator=(const SceneNode&) = delete;
+
+	/// Adds a child placed by local, relative to this node, and returns it. It lives as long as this node.
+	SceneNode& addChild(const Transform& local = Transform());
+
+	/// The parent of this node, or nullptr for a root.
+	SceneNode* parent() const;
+
+	/// The number of children.
+	std::size_t size() const;
+
+	/// A child, in the order they were added.
+	SceneNode& child(std::size_t i) const;
+
+	/// The transform placing this node relative to its parent.
+	const Transform& local() const;
+
+	/// Replaces the local transform, making the world transforms of this subtree dirty. Complexity: O(dirtied nodes)
+	void setLocal(const Transform& local);
+
+	/// The transform placing this node in the world. Complexity: O(1) if clean, O(dirty ancestors) otherwise
+	const Transform& world() const;
+
+	/// Whether world() has to be computed again.
+	bool dirty() const;
+
+	/// Computes the world transforms of all dirty nodes of this subtree, and their inverses.
+	void update() const;
+
+private:
+
+	SceneNode(SceneNode* parent, const Transform& local);
+
+	void markDirty();
+
+	SceneNode* _parent;
+	std::vector<std::unique_ptr<SceneNode>> _children;
+
+	Transform _local;
+	mutable Transform _world;
+	mutable bool _dirty;            //!< When set, it is also set on all descendants.
+
+};
+
+}
@@ -8,7 +8,7 @@ namespace geometry {
 class Solid : public Mesh {
 public:
 
-	/// Orients the solid positevely. Complexity: O(n²)
+	/// Orients the solid positevely. Complexity: O(n log n)
 	/*!
 		n is the total number of triangles in the mesh
 		It flips the normal vectors of the triangles such that all of them is positive oriented.
@@ -28,14 +28,15 @@ public:
 	/// Centralizes the Solid. Ie, its center will be at origin
 	void centralize();
 	
-	/// \brief Produces a unit cube
+	/// \brief Produces a unit cube, centered at the origin and positively oriented
 	///
-	/// Unit cube: All edges sizes of all cube faces equals to 1
+	/// Unit cube: All edges sizes of all cube faces equals to 1. It is staticCube() converted to a Solid
 	static Solid cube();
 	
-	/// \brief Produces a unit pyramid
+	/// \brief Produces a unit pyramid, centered at the origin and positively oriented
 	///
-	/// Unit pyramid: The base perimeter equals 1, and the height equals 1.
+	/// Unit pyramid: The base is a regular polygon of unit sides, and the height equals 1. It is staticCone<sides>()
+	/// converted to a Solid. Throws if sides is not between 3 and 8.
 	static Solid cone(unsigned sides);
 };
 
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/Functions>
+#include <math/cte>
+#include <geometry/Solid>
+#include <geometry/Ray>
+#include <geometry/HitBuffer>
+#include <geometry/PackedTriangle>
+#include <geometry/TriangleHit>
+
+namespace geometry {
+
+/*!
+ * \brief The StaticMesh class is a triangle mesh of NV vertices and NT triangles, sized at compile time.
+ *
+ * Vertices and triangles are stored inline, with no allocation, and triangles refer to their vertices by index.
+ * Everything but the conversion to a Solid and the ray casts is constexpr, so small primitives such as staticCube()
+ * can be built into constants. Their volume, center and ray casts work on the static form directly, and toSolid()
+ * makes a full Mesh only when one is needed.
+ *
+ * Triangles are positively oriented when their vertices go counterclockwise seen from outside. volume() assumes it.
+ */
+template <unsigned NV, unsigned NT>
+class StaticMesh {
+	static_assert(NV > 0 && NT > 0, "A StaticMesh needs vertices and triangles");
+public:
+
+	static constexpr unsigned vertexCount = NV;
+	static constexpr unsigned triangleCount = NT;
+
+	/// Constructs a mesh with all vertices at the origin and all triangles on the first vertex.
+	constexpr StaticMesh();
+
+	constexpr const math::Vector3& vertex(unsigned i) const;
+	constexpr void setVertex(unsigned i, const math::Vector3& position);
+
+	/// The index of the k-th vertex of triangle t.
+	constexpr unsigned index(unsigned t, unsigned k) const;
+	constexpr void setTriangle(unsigned t, unsigned a, unsigned b, unsigned c);
+
+	/// Measures the volume of the mesh. Complexity: O(NT)
+	constexpr math::Real volume() const;
+
+	/// The average of the vertices, as Solid::center() gives.
+	constexpr math::Vector3 center() const;
+
+	/// Moves the mesh so that its center is at the origin.
+	constexpr void centralize();
+
+	/// Builds a Solid with the same vertices and triangles, keeping their orientation.
+	Solid toSolid() const;
+
+	/// Casts the ray on the triangles. Triangle ids are triangle indices. The buffer is cleared first and ends up finished
+	void cast(const Ray& ray, HitBuffer& hits) const;
+
+	/// Casts the ray on the triangles.
+	RayHitSet cast(const Ray& ray) const;
+
+	/// Checks if the ray hits any triangle.
+	bool castAny(const Ray& ray) const;
+
+private:
+
+	PackedTriangle packed(unsigned t) const;
+
+	math::Vector3 _vertices[NV];
+	unsigned _triangles[NT][3];
+
+};
+
+template <unsigned NV, unsigned NT>
+constexpr unsigned StaticMesh<NV, NT>::vertexCount;
+
+template <unsigned NV, unsigned NT>
+constexpr unsigned StaticMesh<NV, NT>::triangleCount;
+
+template <unsigned NV, unsigned NT>
+inline constexpr StaticMesh<NV, NT>::StaticMesh() : _vertices(), _triangles() {
+
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr const math::Vector3& StaticMesh<NV, NT>::vertex(unsigned i) const {
+	return _vertices[i];
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr void StaticMesh<NV, NT>::setVertex(unsigned i, const math::Vector3& position) {
+	_vertices[i] = position;
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr unsigned StaticMesh<NV, NT>::index(unsigned t, unsigned k) const {
+	return _triangles[t][k];
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr void StaticMesh<NV, NT>::setTriangle(unsigned t, unsigned a, unsigned b, unsigned c) {
+	if (a >= NV || b >= NV || c >= NV) throw std::logic_error("Triangle on a vertex out of the mesh");
+	_triangles[t][0] = a;
+	_triangles[t][1] = b;
+	_triangles[t][2] = c;
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr math::Real StaticMesh<NV, NT>::volume() const {
+	// Sum of the signed volumes of the tetrahedra joining each triangle to the origin
+	math::Accumulator volume = 0;
+	for (unsigned t = 0; t < NT; ++t) {
+		const math::Vector3& a = _vertices[_triangles[t][0]];
+		const math::Vector3& b = _vertices[_triangles[t][1]];
+		const math::Vector3& c = _vertices[_triangles[t][2]];
+		volume += a.dot(b.cross(c));
+	}
+	return math::Real(volume / 6);
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr math::Vector3 StaticMesh<NV, NT>::center() const {
+	math::Vector<3, math::Accumulator> center;
+	for (unsigned i = 0; i < NV; ++i)
+		center += math::Vector<3, math::Accumulator>(_vertices[i]);
+	center /= math::Accumulator(NV);
+	return math::Vector3(center);
+}
+
+template <unsigned NV, unsigned NT>
+inline constexpr void StaticMesh<NV, NT>::centralize() {
+	math::Vector3 c = center();
+	for (unsigned i = 0; i < NV; ++i)
+		_vertices[i] -= c;
+}
+
+template <unsigned NV, unsigned NT>
+inline Solid StaticMesh<NV, NT>::toSolid() const {
+	Solid solid;
+	solid.addTriangles(_vertices, NV, _triangles, NT);
+	return solid;
+}
+
+template <unsigned NV, unsigned NT>
+inline PackedTriangle StaticMesh<NV, NT>::packed(unsigned t) const {
+	PackedTriangle triangle;
+	for (unsigned k = 0; k < 3; ++k)
+		triangle.vertices[k] = _vertices[_triangles[t][k]];
+	return triangle;
+}
+
+template <unsigned NV, unsigned NT>
+inline void StaticMesh<NV, NT>::cast(const Ray& ray, HitBuffer& hits) const {
+	hits.clear();
+	for (unsigned t = 0; t < NT; ++t) {
+		TriangleHit hit;
+		if (ray.castOnTriangle(packed(t), t, hit))
+			hits.add(hit);
+	}
+	hits.finish();
+}
+
+template <unsigned NV, unsigned NT>
+inline RayHitSet StaticMesh<NV, NT>::cast(const Ray& ray) const {
+	HitBuffer hits;
+	cast(ray, hits);
+	return RayHitSet{ray, hits};
+}
+
+template <unsigned NV, unsigned NT>
+inline bool StaticMesh<NV, NT>::castAny(const Ray& ray) const {
+	for (unsigned t = 0; t < NT; ++t) {
+		TriangleHit hit;
+		if (ray.castOnTriangle(packed(t), t, hit))
+			return true;
+	}
+	return false;
+}
+
+/// \brief The unit cube, centered at the origin and positively oriented.
+///
+/// It has the vertices and triangles of Solid::cube().
+inline constexpr StaticMesh<8, 12> staticCube() {
+	StaticMesh<8, 12> cube;
+	const math::Real h = 0.5;
+	cube.setVertex(0, {-h, -h, -h});
+	cube.setVertex(1, {-h, -h, h});
+	cube.setVertex(2, {-h, h, h});
+	cube.setVertex(3, {-h, h, -h});
+	cube.setVertex(4, {h, -h, -h});
+	cube.setVertex(5, {h, -h, h});
+	cube.setVertex(6, {h, h, h});
+	cube.setVertex(7, {h, h, -h});
+
+	// Two triangles per face, split along the same diagonals as Solid::cube()
+	cube.setTriangle(0, 0, 1, 2);
+	cube.setTriangle(1, 0, 2, 3);
+	cube.setTriangle(2, 4, 6, 5);
+	cube.setTriangle(3, 4, 7, 6);
+	cube.setTriangle(4, 0, 5, 1);
+	cube.setTriangle(5, 4, 5, 0);
+	cube.setTriangle(6, 2, 7, 3);
+	cube.setTriangle(7, 6, 7, 2);
+	cube.setTriangle(8, 1, 6, 2);
+	cube.setTriangle(9, 5, 6, 1);
+	cube.setTriangle(10, 0, 3, 4);
+	cube.setTriangle(11, 4, 3, 7);
+	return cube;
+}
+
+/// \brief A pyramid over a regular polygon of N unit sides, of height 1, centered at the origin and positively oriented.
+///
+/// The base is split in a fan of triangles from its first vertex. The apex is the last vertex.
+template <unsigned N>
+inline constexpr StaticMesh<N + 1, 2*N - 2> staticCone() {
+	static_assert(N >= 3, "A cone needs at least 3 sides");
+	StaticMesh<N + 1, 2*N - 2> cone;
+
+	// The circumradius of a polygon of unit sides
+	const math::Real radius = 1 / (2 * math::cmath::sin(math::cte::pi / N));
+	for (unsigned k = 0; k < N; ++k) {
+		math::Real angle = math::cte::tau * k / N;
+		cone.setVertex(k, {radius * math::cmath::cos(angle), radius * math::cmath::sin(angle), 0});
+	}
+	cone.setVertex(N, {0, 0, 1});
+
+	// The base faces down, so its triangles go clockwise seen from above
+	for (unsigned k = 1; k + 1 < N; ++k)
+		cone.setTriangle(k - 1, 0, k + 1, k);
+	for (unsigned k = 0; k < N; ++k)
+		cone.setTriangle(N - 2 + k, k, (k + 1) % N, N);
+
+	cone.centralize();
+	return cone;
+}
+
+} // namespace geometry
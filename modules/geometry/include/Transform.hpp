@@ -3,39 +3,126 @@
 #include <math/Real>
 #include <math/Matrix>
 #include <math/Vector>
+#include <math/Quaternion>
+#include <math/VectorArray>
+#include <math/ThreadPool>
 
 namespace geometry {
 
+/*!
+ * \brief The Transform class composes scalings, translations and rotations. Each new operation applies to points
+ * before the ones already stored.
+ *
+ * The transformation is kept in affine form, a 3x3 linear part and a translation, so a point is transformed with 9
+ * multiply-adds plus the translation, with no homogeneous coordinate and no bottom row.
+ *
+ * Rotations are composed as a quaternion, and only multiplied into the linear part when a scaling follows them, so a
+ * run of rotations costs one matrix product instead of one per rotation.
+ *
+ * The inverse is computed on the first call to inverse() or tryInverse() after a change, and kept until the next one.
+ * That first call writes the cache, so it must not race with other calls on the same Transform.
+ */
 class Transform {
-	math::Matrix4 _transform;
+	/// Every operation up to the last scaling
+	math::Matrix3 _linear;
+	math::Vector3 _translation;
+
+	/// The rotations performed since, applied to points before _linear
+	math::Quaternion _rotation;
+	bool _rotated;
+
+	enum class InverseState { Unknown, Valid, Singular };
+
+	mutable math::Matrix3 _inverseLinear;
+	mutable math::Vector3 _inverseTranslation;
+	mutable InverseState _inverseState;
+
+	/// Multiplies _rotation into _linear
+	void flush();
+
+	/// Fills the inverse cache if needed. Returns false if there is no inverse
+	bool computeInverse() const;
 
 public:
 
 	Transform();
-	
+
+	/// Scales, then rotates, then translates, the inverse of decompose()
+	Transform(const math::Vector3& translation, const math::Quaternion& rotation, const math::Vector3& scale);
+
 	/// Peform a uniform scaling
 	void scale(math::Real scale);
-	
+
 	/// Peform a non-uniform scaling
 	void scale(const math::Vector3& scale);
-	
+
 	/// Peform a translation
 	void translate(const math::Vector3& translate);
-	
+
 	/// Rotation arround X axis. Angle in rads.
 	void rotateX(const math::Real& angle);
-	
+
 	/// Rotation arround Y axis. Angle in rads.
 	void rotateY(const math::Real& angle);
-	
+
 	/// Rotation arround Z axis. Angle in rads.
 	void rotateZ(const math::Real& angle);
-	
+
+	/// Rotation given by a unit quaternion
+	void rotate(const math::Quaternion& rotation);
+
 	/// Clear all transformations stored
 	void clear();
-	
+
+	/// The transformation that first applies other, then this one
+	Transform operator*(const Transform& other) const;
+
+	/// Appends other, which then applies to points before the operations already stored
+	Transform& operator*=(const Transform& other);
+
 	/// Application of the transformation in a point
 	math::Vector3 apply(const math::Vector3& point) const;
+
+	/// Application of the transformation in a vector. Unlike points, vectors are not translated
+	math::Vector3 applyVector(const math::Vector3& vector) const;
+
+	/// \brief Application of the transformation in many points at once, on SIMD registers. out may be points
+	///
+	/// When a pool is given, the points are split between its threads.
+	void apply(const math::VectorArray<3>& points, math::VectorArray<3>& out, math::ThreadPool* pool = nullptr) const;
+
+	/// Application of the transformation in many vectors at once. out may be vectors
+	void applyVector(const math::VectorArray<3>& vectors, math::VectorArray<3>& out, math::ThreadPool* pool = nullptr) const;
+
+	/// \brief Application of the transformation in many surface normals at once. out may be normals
+	///
+	/// Unlike vectors, normals stay perpendicular to the transformed surface under non-uniform scalings. They come out
+	/// unit. Throws if the transformation is not invertible.
+	void applyNormal(const math::VectorArray<3>& normals, math::VectorArray<3>& out, math::ThreadPool* pool = nullptr) const;
+
+	/// The transformation that undoes this one. Throws if this one is not invertible, ie. scales by zero
+	Transform inverse() const;
+
+	/// The transformation that undoes this one, without throwing. Returns false, leaving result untouched, if there is none
+	bool tryInverse(Transform& result) const;
+
+	/// \brief Splits the transformation into a scaling, then a rotation, then a translation. Throws if it is not invertible
+	///
+	/// Exact when no non-uniform scaling is followed by a rotation. Otherwise the transformation has a shear, which is
+	/// lost. A reflection comes out as a negative x scale.
+	void decompose(math::Vector3& translation, math::Quaternion& rotation, math::Vector3& scale) const;
+
+	/// The linear part, which transforms vectors
+	math::Matrix3 linear() const;
+
+	/// The translation, where the origin is taken to
+	const math::Vector3& translation() const;
+
+	/// The linear part, followed by the translation as a last column
+	math::Matrix<3, 4> affine() const;
+
+	/// The matrix of the transformation, in homogeneous coordinates
+	math::Matrix4 matrix() const;
 };
 
 } // geometry namespace
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <math/Real>
+
+namespace geometry {
+
+/*!
+ * \brief The TriangleHit struct is the result of an intersection between a ray and a triangle.
+ *
+ * Unlike RayHit, it doesn't hold the Ray, so it is cheap to copy around. The hit point is
+ * (1 - u - v) * r0 + u * r1 + v * r2, where r0, r1 and r2 are the triangle vertices.
+ */
+struct TriangleHit {
+	math::Real distance;  //!< Distance along the ray, in multiples of its direction.
+	math::Real u;         //!< Barycentric weight of the second vertex.
+	math::Real v;         //!< Barycentric weight of the third vertex.
+	unsigned triangle;    //!< Id of the triangle, as given to the intersection test.
+};
+
+} // namespace geometry
@@ -0,0 +1,80 @@
+#include <geometry/BoundingBox>
+#include <algorithm>
+#include <limits>
+
+using namespace geometry;
+using namespace math;
+
+BoundingBox::BoundingBox() {
+	Real inf = std::numeric_limits<Real>::infinity();
+	_min = {inf, inf, inf};
+	_max = {-inf, -inf, -inf};
+}
+
+BoundingBox::BoundingBox(const Vector3& min, const Vector3& max)
+	: _min(min), _max(max) {
+
+}
+
+const Vector3& BoundingBox::min() const {
+	return _min;
+}
+
+const Vector3& BoundingBox::max() const {
+	return _max;
+}
+
+bool BoundingBox::isEmpty() const {
+	return _min.x() > _max.x() || _min.y() > _max.y() || _min.z() > _max.z();
+}
+
+void BoundingBox::extend(const Vector3& point) {
+	for (unsigned i = 0; i < 3; ++i) {
+		_min(i) = std::min(_min(i), point(i));
+		_max(i) = std::max(_max(i), point(i));
+	}
+}
+
+void BoundingBox::extend(const BoundingBox& box) {
+	for (unsigned i = 0; i < 3; ++i) {
+		_min(i) = std::min(_min(i), box._min(i));
+		_max(i) = std::max(_max(i), box._max(i));
+	}
+}
+
+void BoundingBox::inflate(Real margin) {
+	if (isEmpty()) return;
+
+	for (unsigned i = 0; i < 3; ++i) {
+		_min(i) -= margin;
+		_max(i) += margin;
+	}
+}
+
+bool BoundingBox::contains(const Vector3& point) const {
+	for (unsigned i = 0; i < 3; ++i)
+		if (point(i) < _min(i) || point(i) > _max(i))
+			return false;
+	return true;
+}
+
+Vector3 BoundingBox::center() const {
+	return (_min + _max) / 2.0;
+}
+
+Vector3 BoundingBox::extent() const {
+	if (isEmpty()) return {0, 0, 0};
+	return _max - _min;
+}
+
+Real BoundingBox::area() const {
+	Vector3 e = extent();
+	return 2 * (e.x()*e.y() + e.y()*e.z() + e.z()*e.x());
+}
+
+unsigned BoundingBox::largestAxis() const {
+	Vector3 e = extent();
+	if (e.x() >= e.y() && e.x() >= e.z()) return 0;
+	if (e.y() >= e.z()) return 1;
+	return 2;
+}
@@ -0,0 +1,145 @@
+#include <geometry/Bvh>
+#include <geometry/Vertex>
+#include <geometry/RayHit>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#include "BvhBuilder.hpp"
+
+using namespace geometry;
+using namespace math;
+
+constexpr unsigned Bvh::maxDepth;
+
+namespace {
+
+/// \brief Box of a triangle, inflated by a tiny margin.
+///
+/// The margin keeps rays that graze an edge from missing the box while the intersection test, with its
+/// own rounding, still accepts them. Without it, a cast on the Bvh could miss a hit the brute force cast finds.
+BoundingBox triangleBox(const Triangle& triangle) {
+	BoundingBox box;
+	Real magnitude = 1;
+	for (const Vertex& v : triangle.vertices()) {
+		box.extend(v.position());
+		for (unsigned i = 0; i < 3; ++i)
+			magnitude = std::max(magnitude, std::abs(v.position()(i)));
+	}
+
+	box.inflate(magnitude * 16 * RayHit::edgeTolerance);
+	return box;
+}
+
+}
+
+Bvh::Bvh(const Mesh& mesh, Quality quality, ThreadPool* pool) {
+	std::vector<Triangle> triangles(mesh.triangles().begin(), mesh.triangles().end());
+
+	std::vector<BoundingBox> boxes(triangles.size());
+	unsigned chunks = BvhBuilder::chunkCount(triangles.size(), pool);
+	BvhBuilder::parallelChunks(triangles.size(), chunks, pool, [&](unsigned, unsigned begin, unsigned end) {
+		for (unsigned i = begin; i < end; ++i)
+			boxes[i] = triangleBox(triangles[i]);
+	});
+
+	std::vector<unsigned> order;
+	BvhBuilder(boxes, quality, pool).build(_nodes, order);
+
+	_triangles.reserve(order.size());
+	_packed.reserve(order.size());
+	for (unsigned i : order) {
+		_triangles.push_back(triangles[i]);
+		_packed.emplace_back(triangles[i]);
+	}
+
+	_parents.resize(_nodes.size(), 0);
+	for (unsigned i = 0; i < _nodes.size(); ++i) {
+		if (!_nodes[i].isLeaf()) {
+			_parents[_nodes[i].first] = i;
+			_parents[_nodes[i].first + 1] = i;
+		}
+	}
+	_isTouched.resize(_nodes.size(), false);
+}
+
+const std::vector<Bvh::Node>& Bvh::nodes() const {
+	return _nodes;
+}
+
+const std::vector<Triangle>& Bvh::triangles() const {
+	return _triangles;
+}
+
+const std::vector<PackedTriangle>& Bvh::packedTriangles() const {
+	return _packed;
+}
+
+const BoundingBox& Bvh::bounds() const {
+	static const BoundingBox empty;
+	return _nodes.empty() ? empty : _nodes[0].box;
+}
+
+bool Bvh::isEmpty() const {
+	return _nodes.empty();
+}
+
+void Bvh::refitNode(unsigned node) {
+	Node& n = _nodes[node];
+	BoundingBox box;
+	if (n.isLeaf()) {
+		for (unsigned i = n.first; i < n.first + n.count; ++i) {
+			_packed[i] = PackedTriangle(_triangles[i]);
+			box.extend(triangleBox(_triangles[i]));
+		}
+	} else {
+		box.extend(_nodes[n.first].box);
+		box.extend(_nodes[n.first + 1].box);
+	}
+	n.box = box;
+}
+
+void Bvh::refit() {
+	// Children are always stored after their parents, so going backwards visits every child before its parent
+	for (unsigned i = _nodes.size(); i > 0; --i)
+		refitNode(i - 1);
+
+	for (unsigned node : _touched)
+		_isTouched[node] = false;
+	_touched.clear();
+}
+
+void Bvh::touch(const Vertex& vertex) {
+	for (const Triangle& t : vertex.triangles())
+		touch(t);
+}
+
+void Bvh::touch(const Triangle& triangle) {
+	if (_leaves.empty()) {
+		for (unsigned i = 0; i < _nodes.size(); ++i)
+			if (_nodes[i].isLeaf())
+				for (unsigned j = _nodes[i].first; j < _nodes[i].first + _nodes[i].count; ++j)
+					_leaves[_triangles[j]] = i;
+	}
+
+	auto it = _leaves.find(triangle);
+	if (it == _leaves.end()) return;
+
+	// Every ancestor of a touched node is touched, so the walk stops at the first one already marked
+	unsigned node = it->second;
+	while (!_isTouched[node]) {
+		_isTouched[node] = true;
+		_touched.push_back(node);
+		if (node == 0) break;
+		node = _parents[node];
+	}
+}
+
+void Bvh::refitTouched() {
+	std::sort(_touched.begin(), _touched.end(), std::greater<unsigned>());
+	for (unsigned node : _touched) {
+		refitNode(node);
+		_isTouched[node] = false;
+	}
+	_touched.clear();
+}
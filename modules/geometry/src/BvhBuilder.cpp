@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <array>
+
+#include "BvhBuilder.hpp"
+
+using namespace geometry;
+using namespace math;
+
+constexpr Real BvhBuilder::traversalCost;
+constexpr Real BvhBuilder::intersectionCost;
+constexpr unsigned BvhBuilder::maxLeafSize;
+constexpr unsigned BvhBuilder::binCount;
+constexpr unsigned BvhBuilder::minParallelSubtree;
+constexpr unsigned BvhBuilder::minParallelNode;
+
+BvhBuilder::BvhBuilder(const std::vector<BoundingBox>& boxes, Bvh::Quality quality, ThreadPool* pool)
+	: _nodes(nullptr), _nodeCount(0), _quality(quality), _pool(pool) {
+	_references.resize(boxes.size());
+	parallelChunks(boxes.size(), chunkCount(boxes.size(), pool), pool, [&](unsigned, unsigned begin, unsigned end) {
+		for (unsigned i = begin; i < end; ++i)
+			_references[i] = {boxes[i], boxes[i].center(), i};
+	});
+}
+
+unsigned BvhBuilder::chunkCount(unsigned count, ThreadPool* pool) {
+	return pool && count >= minParallelNode ? std::min(pool->size(), count) : 1;
+}
+
+void BvhBuilder::build(std::vector<Bvh::Node>& nodes, std::vector<unsigned>& order) {
+	nodes.clear();
+	order.clear();
+	if (_references.empty()) return;
+
+	// A binary tree with n leaves has 2n-1 nodes, so this is never outgrown and threads can fill it freely
+	nodes.resize(2 * _references.size() - 1);
+	_scratch.resize(_references.size());
+	if (_quality == Bvh::Quality::High)
+		_rightAreas.resize(_references.size());
+
+	_nodes = &nodes;
+	_nodeCount = 1;
+
+	// Split the top nodes one at a time, with all threads on each, until every thread can take a subtree of its own
+	unsigned threads = _pool ? _pool->size() : 1;
+	Task root = {0, 0, unsigned(_references.size()), 1};
+	std::vector<Task> pending, subtrees;
+	(root.end >= minParallelSubtree ? pending : subtrees).push_back(root);
+
+	while (!pending.empty() && pending.size() < threads) {
+		std::vector<Task> next;
+		for (const Task& task : pending) {
+			unsigned split;
+			unsigned children = splitNode(task, _pool, split);
+			if (children == 0) continue;
+
+			Task left = {children, task.begin, split, task.depth + 1};
+			Task right = {children + 1, split, task.end, task.depth + 1};
+			(split - task.begin >= minParallelSubtree ? next : subtrees).push_back(left);
+			(task.end - split >= minParallelSubtree ? next : subtrees).push_back(right);
+		}
+		pending.swap(next);
+	}
+	subtrees.insert(subtrees.end(), pending.begin(), pending.end());
+
+	auto body = [&](std::size_t first, std::size_t last) {
+		for (std::size_t i = first; i < last; ++i)
+			buildNode(subtrees[i]);
+	};
+	if (_pool) _pool->parallelFor(subtrees.size(), 1, body);
+	else body(0, subtrees.size());
+
+	nodes.resize(_nodeCount);
+	_nodes = nullptr;
+
+	order.reserve(_references.size());
+	for (const Reference& ref : _references)
+		order.push_back(ref.index);
+}
+
+unsigned BvhBuilder::allocatePair() {
+	return _nodeCount.fetch_add(2);
+}
+
+void BvhBuilder::makeLeaf(unsigned node, unsigned begin, unsigned end) {
+	(*_nodes)[node].first = begin;
+	(*_nodes)[node].count = end - begin;
+}
+
+unsigned BvhBuilder::splitNode(const Task& task, ThreadPool* pool, unsigned& split) {
+	unsigned begin = task.begin;
+	unsigned end = task.end;
+	unsigned count = end - begin;
+
+	BoundingBox box;
+	unsigned chunks = chunkCount(count, pool);
+	if (chunks > 1) {
+		std::vector<BoundingBox> partial(chunks);
+		parallelChunks(count, chunks, pool, [&](unsigned chunk, unsigned b, unsigned e) {
+			for (unsigned i = begin + b; i < begin + e; ++i)
+				partial[chunk].extend(_references[i].box);
+		});
+		for (const BoundingBox& p : partial)
+			box.extend(p);
+	} else {
+		for (unsigned i = begin; i < end; ++i)
+			box.extend(_references[i].box);
+	}
+	(*_nodes)[task.node].box = box;
+
+	if (count == 1 || task.depth >= Bvh::maxDepth) {
+		makeLeaf(task.node, begin, end);
+		return 0;
+	}
+
+	split = _quality == Bvh::Quality::High
+		? sweepSplit(begin, end, box)
+		: binnedSplit(begin, end, box, pool);
+
+	if (split == begin) {
+		if (count <= maxLeafSize) {
+			makeLeaf(task.node, begin, end);
+			return 0;
+		}
+
+		// Too many primitives for a leaf and no split helps. Split in half along the largest axis.
+		sortByAxis(begin, end, box.largestAxis());
+		split = begin + count / 2;
+	}
+
+	unsigned children = allocatePair();
+	(*_nodes)[task.node].first = children;
+	(*_nodes)[task.node].count = 0;
+	return children;
+}
+
+void BvhBuilder::buildNode(const Task& task) {
+	unsigned split;
+	unsigned children = splitNode(task, nullptr, split);
+	if (children == 0) return;
+
+	buildNode({children, task.begin, split, task.depth + 1});
+	buildNode({children + 1, split, task.end, task.depth + 1});
+}
+
+void BvhBuilder::sortByAxis(unsigned begin, unsigned end, unsigned axis) {
+	// Ties are broken by index so the resulting tree doesn't depend on the sort implementation
+	std::sort(_references.begin() + begin, _references.begin() + end, [axis](const Reference& a, const Reference& b) {
+		if (a.center(axis) != b.center(axis)) return a.center(axis) < b.center(axis);
+		return a.index < b.index;
+	});
+}
+
+unsigned BvhBuilder::sweepSplit(unsigned begin, unsigned end, const BoundingBox& box) {
+	unsigned count = end - begin;
+
+	// Areas are relative to the node area. A flat node has no area, so count is used instead.
+	Real area = box.area();
+	Real bestCost = intersectionCost * count;
+	unsigned bestAxis = 0;
+	unsigned bestSplit = begin;
+
+	for (unsigned axis = 0; axis < 3; ++axis) {
+		sortByAxis(begin, end, axis);
+
+		BoundingBox right;
+		for (unsigned i = end - 1; i > begin; --i) {
+			right.extend(_references[i].box);
+			_rightAreas[i] = right.area();
+		}
+
+		BoundingBox left;
+		for (unsigned i = begin + 1; i < end; ++i) {
+			left.extend(_references[i-1].box);
+			Real leftCount = i - begin;
+			Real rightCount = end - i;
+			Real cost = area > 0
+				? traversalCost + intersectionCost * (left.area() * leftCount + _rightAreas[i] * rightCount) / area
+				: traversalCost + intersectionCost * std::max(leftCount, rightCount);
+
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestSplit = i;
+			}
+		}
+	}
+
+	if (bestSplit != begin && bestAxis != 2)
+		sortByAxis(begin, end, bestAxis);
+
+	return bestSplit;
+}
+
+unsigned BvhBuilder::binnedSplit(unsigned begin, unsigned end, const BoundingBox& box, ThreadPool* pool) {
+	unsigned count = end - begin;
+	unsigned chunks = chunkCount(count, pool);
+
+	// Bins are laid over the box of the centers, not of the primitives, so none of them is wasted
+	std::vector<BoundingBox> partialCenters(chunks);
+	parallelChunks(count, chunks, pool, [&](unsigned chunk, unsigned b, unsigned e) {
+		for (unsigned i = begin + b; i < begin + e; ++i)
+			partialCenters[chunk].extend(_references[i].center);
+	});
+
+	BoundingBox centers;
+	for (const BoundingBox& p : partialCenters)
+		centers.extend(p);
+
+	Vector3 origin = centers.min();
+	Vector3 extent = centers.extent();
+	Vector3 scale;
+	for (unsigned axis = 0; axis < 3; ++axis)
+		scale(axis) = extent(axis) > 0 ? binCount / extent(axis) : 0;
+
+	auto binOf = [&](const Reference& ref, unsigned axis) {
+		unsigned bin = unsigned((ref.center(axis) - origin(axis)) * scale(axis));
+		return std::min(bin, binCount - 1);
+	};
+
+	using AxisBins = std::array<std::array<Bin, binCount>, 3>;
+	std::vector<AxisBins> partialBins(chunks);
+	parallelChunks(count, chunks, pool, [&](unsigned chunk, unsigned b, unsigned e) {
+		AxisBins& bins = partialBins[chunk];
+		for (auto& axisBins : bins)
+			for (Bin& bin : axisBins)
+				bin.count = 0;
+
+		for (unsigned i = begin + b; i < begin + e; ++i) {
+			for (unsigned axis = 0; axis < 3; ++axis) {
+				Bin& bin = bins[axis][binOf(_references[i], axis)];
+				bin.box.extend(_references[i].box);
+				++bin.count;
+			}
+		}
+	});
+
+	AxisBins bins = partialBins[0];
+	for (unsigned chunk = 1; chunk < chunks; ++chunk) {
+		for (unsigned axis = 0; axis < 3; ++axis) {
+			for (unsigned k = 0; k < binCount; ++k) {
+				bins[axis][k].box.extend(partialBins[chunk][axis][k].box);
+				bins[axis][k].count += partialBins[chunk][axis][k].count;
+			}
+		}
+	}
+
+	Real area = box.area();
+	Real bestCost = intersectionCost * count;
+	unsigned bestAxis = 0;
+	unsigned bestBin = 0;
+
+	for (unsigned axis = 0; axis < 3; ++axis) {
+		if (scale(axis) == 0) continue;
+
+		std::array<Real, binCount> rightAreas;
+		std::array<unsigned, binCount> rightCounts;
+		BoundingBox right;
+		unsigned rightCount = 0;
+		for (unsigned k = binCount - 1; k > 0; --k) {
+			right.extend(bins[axis][k].box);
+			rightCount += bins[axis][k].count;
+			rightAreas[k] = right.area();
+			rightCounts[k] = rightCount;
+		}
+
+		BoundingBox left;
+		unsigned leftCount = 0;
+		for (unsigned k = 1; k < binCount; ++k) {
+			left.extend(bins[axis][k-1].box);
+			leftCount += bins[axis][k-1].count;
+			if (leftCount == 0 || rightCounts[k] == 0) continue;
+
+			Real cost = area > 0
+				? traversalCost + intersectionCost * (left.area() * leftCount + rightAreas[k] * rightCounts[k]) / area
+				: traversalCost + intersectionCost * std::max(leftCount, rightCounts[k]);
+
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = k;
+			}
+		}
+	}
+
+	if (bestBin == 0) return begin;
+
+	return partition(begin, end, chunks, pool, [&](const Reference& ref) {
+		return binOf(ref, bestAxis) < bestBin;
+	});
+}
+
+template <typename Predicate>
+unsigned BvhBuilder::partition(unsigned begin, unsigned end, unsigned chunks, ThreadPool* pool, Predicate left) {
+	unsigned count = end - begin;
+
+	std::vector<unsigned> leftCounts(chunks, 0);
+	parallelChunks(count, chunks, pool, [&](unsigned chunk, unsigned b, unsigned e) {
+		for (unsigned i = begin + b; i < begin + e; ++i)
+			if (left(_references[i])) ++leftCounts[chunk];
+	});
+
+	// Each chunk writes its left references after the ones of the previous chunks, and the same for the right ones
+	std::vector<unsigned> leftOffsets(chunks);
+	unsigned totalLeft = 0;
+	for (unsigned chunk = 0; chunk < chunks; ++chunk) {
+		leftOffsets[chunk] = totalLeft;
+		totalLeft += leftCounts[chunk];
+	}
+
+	parallelChunks(count, chunks, pool, [&](unsigned chunk, unsigned b, unsigned e) {
+		unsigned l = begin + leftOffsets[chunk];
+		unsigned r = begin + totalLeft + (b - leftOffsets[chunk]);
+		for (unsigned i = begin + b; i < begin + e; ++i) {
+			if (left(_references[i])) _scratch[l++] = _references[i];
+			else _scratch[r++] = _references[i];
+		}
+	});
+
+	parallelChunks(count, chunks, pool, [&](unsigned, unsigned b, unsigned e) {
+		std::copy(_scratch.begin() + begin + b, _scratch.begin() + begin + e, _references.begin() + begin + b);
+	});
+
+	return begin + totalLeft;
+}
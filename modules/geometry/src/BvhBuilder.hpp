@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/ThreadPool>
+#include <geometry/Bvh>
+#include <geometry/BoundingBox>
+
+namespace geometry {
+
+/*!
+ * \brief Builds the tree of a Bvh from the boxes of its primitives.
+ *
+ * The builder only sees boxes, so it doesn't care whether the primitives are triangles or anything else.
+ * It produces the nodes and the order in which the primitives must be stored for the leaves to reference them.
+ *
+ * With a pool, the top nodes are split one after the other, each sharing its binning and partitioning between the
+ * threads. Once there are as many pending subtrees as threads, each subtree is built whole by one of them.
+ */
+class BvhBuilder {
+public:
+
+	/// When a pool is given, the build is split between its threads.
+	BvhBuilder(const std::vector<BoundingBox>& boxes, Bvh::Quality quality, math::ThreadPool* pool);
+
+	/// Builds the tree. order[i] will be the index in boxes of the i-th primitive referenced by the leaves.
+	void build(std::vector<Bvh::Node>& nodes, std::vector<unsigned>& order);
+
+	/// Cost of visiting an inner node, relative to intersectionCost.
+	static constexpr math::Real traversalCost = 1;
+
+	/// Cost of testing a primitive.
+	static constexpr math::Real intersectionCost = 1;
+
+	/// Nodes with more primitives than this are always split, even if SAH finds it no better.
+	static constexpr unsigned maxLeafSize = 8;
+
+	/// Number of bins per axis on Quality::Fast builds.
+	static constexpr unsigned binCount = 16;
+
+	/// Subtrees smaller than this are built whole by one thread, without splitting the top nodes any further.
+	static constexpr unsigned minParallelSubtree = 4096;
+
+	/// Nodes smaller than this do their binning and partitioning on a single thread.
+	static constexpr unsigned minParallelNode = 16384;
+
+	/// Returns the number of chunks parallelChunks() should split count elements into, one per thread of the pool.
+	static unsigned chunkCount(unsigned count, math::ThreadPool* pool);
+
+	/// Splits [0, count) into contiguous chunks and calls f(chunk, begin, end) for each, on the threads of the pool.
+	template <typename F>
+	static void parallelChunks(unsigned count, unsigned chunks, math::ThreadPool* pool, F f);
+
+private:
+
+	struct Reference {
+		BoundingBox box;
+		math::Vector3 center;
+		unsigned index;
+	};
+
+	struct Bin {
+		BoundingBox box;
+		unsigned count;
+	};
+
+	/// A node whose references are known but which isn't split yet.
+	struct Task {
+		unsigned node;
+		unsigned begin;
+		unsigned end;
+		unsigned depth;
+	};
+
+	/// Makes the node a leaf or splits it. Returns the first of its two children, or zero for a leaf.
+	unsigned splitNode(const Task& task, math::ThreadPool* pool, unsigned& split);
+
+	/// Builds the whole subtree of a node on the calling thread.
+	void buildNode(const Task& task);
+	void makeLeaf(unsigned node, unsigned begin, unsigned end);
+	unsigned allocatePair();
+
+	/// Finds the best split among all positions along each axis. Returns begin if no split beats a leaf.
+	unsigned sweepSplit(unsigned begin, unsigned end, const BoundingBox& box);
+	void sortByAxis(unsigned begin, unsigned end, unsigned axis);
+
+	/// Finds the best split among the bin boundaries along each axis. Returns begin if no split beats a leaf.
+	unsigned binnedSplit(unsigned begin, unsigned end, const BoundingBox& box, math::ThreadPool* pool);
+
+	/// Moves the references for which left is true to the front, keeping their relative order. Returns the split position.
+	template <typename Predicate>
+	unsigned partition(unsigned begin, unsigned end, unsigned chunks, math::ThreadPool* pool, Predicate left);
+
+	std::vector<Reference> _references;
+	std::vector<Reference> _scratch;        //!< Partitioning buffer, parallel to _references.
+	std::vector<math::Real> _rightAreas;    //!< Sweep buffer, parallel to _references.
+	std::vector<Bvh::Node>* _nodes;
+	std::atomic<unsigned> _nodeCount;
+	Bvh::Quality _quality;
+	math::ThreadPool* _pool;
+
+};
+
+template <typename F>
+void BvhBuilder::parallelChunks(unsigned count, unsigned chunks, math::ThreadPool* pool, F f) {
+	if (!pool || chunks <= 1) {
+		f(0u, 0u, count);
+		return;
+	}
+
+	pool->parallelFor(chunks, 1, [&](std::size_t first, std::size_t last) {
+		for (unsigned chunk = unsigned(first); chunk < last; ++chunk) {
+			unsigned begin = unsigned(uint64_t(count) * chunk / chunks);
+			unsigned end = unsigned(uint64_t(count) * (chunk + 1) / chunks);
+			f(chunk, begin, end);
+		}
+	});
+}
+
+} // namespace geometry
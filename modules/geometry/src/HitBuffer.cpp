@@ -0,0 +1,47 @@
+#include <geometry/HitBuffer>
+#include <geometry/RayHitSet>
+#include <algorithm>
+
+using namespace geometry;
+
+void HitBuffer::clear() {
+	_hits.clear();
+}
+
+void HitBuffer::add(const TriangleHit& hit) {
+	_hits.push_back(hit);
+}
+
+void HitBuffer::finish() {
+	std::sort(_hits.begin(), _hits.end(), [](const TriangleHit& a, const TriangleHit& b) {
+		return a.distance < b.distance || (a.distance == b.distance && a.triangle < b.triangle);
+	});
+
+	// Whether a hit stays depends on the one after it, which is always read before being moved
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < _hits.size(); ++i)
+		if (i + 1 == _hits.size() || _hits[i+1].distance - _hits[i].distance >= RayHitSet::duplicateDistance)
+			_hits[kept++] = _hits[i];
+
+	_hits.resize(kept);
+}
+
+std::size_t HitBuffer::size() const {
+	return _hits.size();
+}
+
+bool HitBuffer::empty() const {
+	return _hits.empty();
+}
+
+const TriangleHit& HitBuffer::operator[](std::size_t i) const {
+	return _hits[i];
+}
+
+HitBuffer::const_iterator HitBuffer::begin() const {
+	return _hits.begin();
+}
+
+HitBuffer::const_iterator HitBuffer::end() const {
+	return _hits.end();
+}
@@ -0,0 +1,111 @@
+#include <geometry/InstanceBvh>
+#include <geometry/RayHit>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "BvhBuilder.hpp"
+
+using namespace geometry;
+using namespace math;
+
+InstanceBvh::InstanceBvh() : _needsBuild(false), _needsRefit(false) {
+
+}
+
+void InstanceBvh::place(Instance& instance, const Transform& transform) {
+	if (!transform.tryInverse(instance.inverse)) throw std::logic_error("Transform is not invertible");
+	instance.transform = transform;
+
+	// The box of the transformed mesh box is computed from its 8 corners, so it is O(1) regardless of the mesh
+	instance.box = BoundingBox();
+	const BoundingBox& local = instance.bvh->bounds();
+	if (local.isEmpty()) return;
+
+	for (unsigned corner = 0; corner < 8; ++corner) {
+		Vector3 point = {
+			corner & 1 ? local.max().x() : local.min().x(),
+			corner & 2 ? local.max().y() : local.min().y(),
+			corner & 4 ? local.max().z() : local.min().z()
+		};
+		instance.box.extend(transform.apply(point));
+	}
+
+	// Rounding on the transform may leave the mesh slightly out of the box
+	Real magnitude = 1;
+	for (unsigned i = 0; i < 3; ++i)
+		magnitude = std::max({magnitude, std::abs(instance.box.min()(i)), std::abs(instance.box.max()(i))});
+	instance.box.inflate(magnitude * 16 * RayHit::edgeTolerance);
+}
+
+unsigned InstanceBvh::add(const Bvh& bvh, const Transform& transform) {
+	Instance instance;
+	instance.bvh = &bvh;
+	place(instance, transform);
+
+	_instances.push_back(instance);
+	_needsBuild = true;
+	return _instances.size() - 1;
+}
+
+void InstanceBvh::move(unsigned instance, const Transform& transform) {
+	if (instance >= _instances.size()) throw std::logic_error("Invalid instance");
+
+	place(_instances[instance], transform);
+	_needsRefit = true;
+}
+
+void InstanceBvh::update() {
+	if (_needsBuild) {
+		std::vector<BoundingBox> boxes;
+		boxes.reserve(_instances.size());
+		for (const Instance& instance : _instances)
+			boxes.push_back(instance.box);
+
+		BvhBuilder(boxes, Bvh::Quality::High, nullptr).build(_nodes, _order);
+	} else if (_needsRefit) {
+		// Children are always stored after their parents, so going backwards visits every child before its parent
+		for (unsigned i = _nodes.size(); i > 0; --i) {
+			Bvh::Node& node = _nodes[i - 1];
+			node.box = BoundingBox();
+			if (node.isLeaf()) {
+				for (unsigned j = node.first; j < node.first + node.count; ++j)
+					node.box.extend(_instances[_order[j]].box);
+			} else {
+				node.box.extend(_nodes[node.first].box);
+				node.box.extend(_nodes[node.first + 1].box);
+			}
+		}
+	}
+
+	_needsBuild = false;
+	_needsRefit = false;
+}
+
+bool InstanceBvh::needsUpdate() const {
+	return _needsBuild || _needsRefit;
+}
+
+unsigned InstanceBvh::size() const {
+	return _instances.size();
+}
+
+const Bvh& InstanceBvh::bvh(unsigned instance) const {
+	return *_instances[instance].bvh;
+}
+
+const Transform& InstanceBvh::transform(unsigned instance) const {
+	return _instances[instance].transform;
+}
+
+const Transform& InstanceBvh::inverse(unsigned instance) const {
+	return _instances[instance].inverse;
+}
+
+const std::vector<Bvh::Node>& InstanceBvh::nodes() const {
+	return _nodes;
+}
+
+const std::vector<unsigned>& InstanceBvh::instances() const {
+	return _order;
+}
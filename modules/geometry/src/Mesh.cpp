@@ -14,7 +14,7 @@
 using namespace math;
 using namespace geometry;
 
-Mesh::Mesh() {
+Mesh::Mesh() : _hasPending(false), _hasPendingInverse(false), _deferred(false) {
 	
 }
 
@@ -22,6 +22,16 @@ Mesh::Mesh(Mesh&& other) {
 	_vertices = std::move(other._vertices);
 	_edges = std::move(other._edges);
 	_triangles = std::move(other._triangles);
+	_pending = other._pending;
+	_hasPending = other._hasPending;
+	_pendingInverse = other._pendingInverse;
+	_hasPendingInverse = other._hasPendingInverse;
+	_deferred = other._deferred;
+	other._pending.clear();
+	other._hasPending = false;
+	other._pendingInverse.clear();
+	other._hasPendingInverse = false;
+	other._deferred = false;
 }
 
 Mesh::~Mesh() {
@@ -36,6 +46,9 @@ Mesh::~Mesh() {
 }
 
 Vertex Mesh::addVertex(Vector3 point) {
+	// The new vertex is already in place, so it must not be moved by the pending transformation
+	flush();
+
 	VertexData* data = nullptr;
 	try {
 		Vertex vertex(data = new VertexData(point));
@@ -57,6 +70,7 @@ Vertex Mesh::addVertex(Vector3 point) {
 }
 
 const std::set<Vertex>& Mesh::vertices() const {
+	flush();
 	return _vertices;
 }
 
@@ -99,6 +113,7 @@ Edge Mesh::addEdge(Vertex v1, Vertex v2) {
 }
 
 const std::set<Edge>& Mesh::edges() const {
+	flush();
 	return _edges;
 }
 
@@ -119,6 +134,37 @@ Triangle Mesh::addTriangle(Edge e1, Edge e2, Edge e3) {
 	Vertex v1 = e1.vertices()[0];
 	Vertex v2 = e1.vertices()[1];
 	Vertex v3 = e2.vertices()[0] == e1.vertices()[0] || e2.vertices()[0] == e1.vertices()[1] ? e2.vertices()[1] : e2.vertices()[0];
+	return linkTriangle(e1, e2, e3, v1, v2, v3);
+}
+
+void Mesh::addTriangles(const Vector3* points, std::size_t pointCount, const unsigned (*indices)[3], std::size_t triangleCount) {
+	std::vector<Vertex> vertices;
+	vertices.reserve(pointCount);
+	for (std::size_t i = 0; i < pointCount; ++i)
+		vertices.push_back(addVertex(points[i]));
+
+	for (std::size_t t = 0; t < triangleCount; ++t) {
+#ifdef DEBUG
+		if (indices[t][0] >= pointCount || indices[t][1] >= pointCount || indices[t][2] >= pointCount)
+			throw std::logic_error("Triangle on a vertex out of the list");
+#endif
+		// The vertices are new, so the triangle can't exist yet, and it keeps the order of its indices
+		Vertex v1 = vertices[indices[t][0]];
+		Vertex v2 = vertices[indices[t][1]];
+		Vertex v3 = vertices[indices[t][2]];
+		Edge e1 = addEdge(v1, v2);
+		Edge e2 = addEdge(v2, v3);
+		Edge e3 = addEdge(v1, v3);
+
+		// vectorArea() crosses the first two edges as stored, which may run either way, so their order is picked to
+		// agree with v1, v2, v3 instead of measuring it
+		bool sameWay = (e1.vertices()[0] == v1) == (e2.vertices()[0] == v2);
+		if (sameWay) linkTriangle(e2, e1, e3, v1, v2, v3);
+		else linkTriangle(e1, e2, e3, v1, v2, v3);
+	}
+}
+
+Triangle Mesh::linkTriangle(Edge e1, Edge e2, Edge e3, Vertex v1, Vertex v2, Vertex v3) {
 	TriangleData* data = nullptr;
 	try {
 		Triangle triangle(data = new TriangleData(e1, e2, e3, v1, v2, v3));
@@ -175,17 +221,64 @@ Triangle Mesh::addTriangle(Edge e1, Edge e2, Edge e3) {
 }
 
 const std::set<Triangle>& Mesh::triangles() const {
+	flush();
 	return _triangles;
 }
 
 void Mesh::apply(const Transform& transform) {
-	for (Vertex v : _vertices) {
-		Vector3 pos = v.position();
-		v.position() = transform.apply(pos);
-	}
+	// transform comes after the pending ones
+	_pending = transform * _pending;
+	_hasPending = true;
+	if (!_deferred) flush();
+	else _hasPendingInverse = _pending.tryInverse(_pendingInverse);
+}
+
+void Mesh::setDeferred(bool deferred) {
+	_deferred = deferred;
+	if (!deferred) flush();
+}
+
+bool Mesh::deferred() const {
+	return _deferred;
+}
+
+bool Mesh::hasPending() const {
+	return _hasPending;
+}
+
+const Transform& Mesh::pending() const {
+	return _pending;
+}
+
+bool Mesh::hasPendingInverse() const {
+	return _hasPendingInverse;
+}
+
+const Transform& Mesh::pendingInverse() const {
+	return _pendingInverse;
+}
+
+const std::set<Triangle>& Mesh::unflushedTriangles() const {
+	return _triangles;
+}
+
+void Mesh::flush() const {
+	if (!_hasPending) return;
+
+	// Each vertex lives in its own allocation, so walking the set costs more than the arithmetic. Gathering the
+	// positions into a VectorArray for the SIMD kernel and scattering them back walks it twice, and measured about
+	// twice as slow as moving each vertex in place
+	for (Vertex v : _vertices)
+		v.position() = _pending.apply(v.position());
+
+	_pending.clear();
+	_hasPending = false;
+	_hasPendingInverse = false;
 }
 
 void Mesh::write(std::ostream& out) const {
+	flush();
+
 	std::vector<Vertex> vs;
 	std::map<Vertex, unsigned> vindex;
 
@@ -0,0 +1,13 @@
+#include <geometry/PackedTriangle>
+#include <geometry/Vertex>
+
+using namespace geometry;
+
+PackedTriangle::PackedTriangle(const Triangle& triangle)
+	: vertices({{
+		triangle.vertices()[0].position(),
+		triangle.vertices()[1].position(),
+		triangle.vertices()[2].position()
+	}}) {
+
+}
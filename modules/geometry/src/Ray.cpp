@@ -1,12 +1,36 @@
 #include <geometry/Ray>
-#include <math/Matrix>
+#include <geometry/Bvh>
+#include <geometry/InstanceBvh>
+#include <geometry/BoundingBox>
+#include <geometry/PackedTriangle>
+#include <geometry/TriangleHit>
+#include <geometry/HitBuffer>
+#include <geometry/RayHit>
+#include <algorithm>
+#include <cmath>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 using namespace geometry;
 using namespace math;
 
-Ray::Ray(Vector3 origin, Vector3 direction)
-	: _origin(origin), _direction(direction) {
+Ray::Ray(Vector3 origin, Vector3 direction, Real tMin, Real tMax)
+	: _origin(origin), _direction(direction), _tMin(tMin), _tMax(tMax) {
 
+	// z is the dominant axis of the direction. Swapping x and y when it points backwards keeps the winding.
+	_kz = 0;
+	for (unsigned i = 1; i < 3; ++i)
+		if (std::abs(_direction(i)) > std::abs(_direction(_kz)))
+			_kz = i;
+	_kx = (_kz + 1) % 3;
+	_ky = (_kx + 1) % 3;
+	if (_direction(_kz) < 0) std::swap(_kx, _ky);
+
+	_shearX = _direction(_kx) / _direction(_kz);
+	_shearY = _direction(_ky) / _direction(_kz);
+	_shearZ = 1 / _direction(_kz);
 }
 
 Vector3 Ray::origin() const {
@@ -17,47 +41,369 @@ Vector3 Ray::direction() const {
 	return _direction;
 }
 
+Real Ray::tMin() const {
+	return _tMin;
+}
+
+Real Ray::tMax() const {
+	return _tMax;
+}
+
 bool Ray::operator==(const Ray& other) const {
-	return _origin == other._origin && _direction == other._direction;
+	return _origin == other._origin && _direction == other._direction && _tMin == other._tMin && _tMax == other._tMax;
 }
 
 RayHit Ray::castOnTriangle(Triangle triangle) const {
-	Vector3 p = _origin - triangle.vertices()[0].position();
-	Vector3 ej = triangle.vertices()[1].position() - triangle.vertices()[0].position();
-	Vector3 ek = triangle.vertices()[2].position() - triangle.vertices()[0].position();
+	TriangleHit hit;
+	if (castOnTriangle(PackedTriangle(triangle), 0, hit))
+		return RayHit{*this, hit.distance};
+	return RayHit{*this};
+}
 
-	Vector3 solution;
-	Matrix3 mat(-_direction, ej, ek);
+bool Ray::castOnTriangle(const PackedTriangle& triangle, unsigned id, TriangleHit& hit) const {
+	// Watertight ray/triangle intersection, by Woop, Benthin and Wald. The vertices are moved to the space where the
+	// ray starts at the origin and goes along z. There, the signed areas of the edges against the ray tell if it
+	// crosses the triangle. Shared edges give the same areas with opposite signs, so no ray slips between triangles.
+	if (_direction(_kz) == 0) return false;
 
-	try {
-		solution = mat.inverse() * p;
-	} catch (std::logic_error&) {
-		return RayHit{*this};
-	}
+	const Vector3 a = triangle.vertices[0] - _origin;
+	const Vector3 b = triangle.vertices[1] - _origin;
+	const Vector3 c = triangle.vertices[2] - _origin;
+
+	const Real ax = a(_kx) - _shearX * a(_kz);
+	const Real ay = a(_ky) - _shearY * a(_kz);
+	const Real bx = b(_kx) - _shearX * b(_kz);
+	const Real by = b(_ky) - _shearY * b(_kz);
+	const Real cx = c(_kx) - _shearX * c(_kz);
+	const Real cy = c(_ky) - _shearY * c(_kz);
+
+	const Real u = cx * by - cy * bx;
+	const Real v = ax * cy - ay * cx;
+	const Real w = bx * ay - by * ax;
+
+	// A ray exactly on an edge gives a zero area, which rounding turns into either sign. Each area is given a
+	// tolerance well above its rounding error, so edges and vertices always count as part of the triangle.
+	const Real tolerance = RayHit::edgeTolerance;
+	const Real tu = tolerance * (std::abs(cx * by) + std::abs(cy * bx));
+	const Real tv = tolerance * (std::abs(ax * cy) + std::abs(ay * cx));
+	const Real tw = tolerance * (std::abs(bx * ay) + std::abs(by * ax));
+
+	bool front = u >= -tu && v >= -tv && w >= -tw;
+	bool back = u <= tu && v <= tv && w <= tw;
+	if (!front && !back) return false;
 
-	if (solution.x() < 0) return RayHit{*this};
-	if (solution.y() < 0) return RayHit{*this};
-	if (solution.z() < 0) return RayHit{*this};
-	if (solution.y() > 1) return RayHit{*this};
-	if (solution.z() > 1) return RayHit{*this};
+	const Real det = u + v + w;
+	if (det == 0) return false;
 
-	Real w = -solution.y()-solution.z()+1;
+	const Real az = _shearZ * a(_kz);
+	const Real bz = _shearZ * b(_kz);
+	const Real cz = _shearZ * c(_kz);
+	const Real t = (u * az + v * bz + w * cz) / det;
 
-	if (w < 0) return RayHit{*this};
-	if (w > 1) return RayHit{*this};
+	if (!(t >= _tMin && t >= RayHit::minimumDistance && t <= _tMax)) return false;
 
-	return RayHit{*this, solution.x()};
+	hit.distance = t;
+	hit.u = v / det;
+	hit.v = w / det;
+	hit.triangle = id;
+	return true;
 }
 
 RayHitSet Ray::castOnMesh(const Mesh& mesh) const {
-	RayHitSet hits;
-	for (Triangle t : mesh.triangles()) {
-		RayHit hit = castOnTriangle(t);
-		if (hit.hasHit())
-			hits.insert(hit);
+	HitBuffer hits;
+	castOnMesh(mesh, hits);
+	return RayHitSet{*this, hits};
+}
+
+void Ray::castOnMesh(const Mesh& mesh, HitBuffer& hits) const {
+	hits.clear();
+
+	// A pending transformation is left pending, and the ray is moved to where the vertices still are instead.
+	// The transform is affine, so distances along the local ray are the same as along this one
+	bool local = mesh.hasPendingInverse();
+	const Transform& inverse = mesh.pendingInverse();
+	Ray ray = local ? Ray(inverse.apply(_origin), inverse.applyVector(_direction), _tMin, _tMax) : *this;
+
+	unsigned id = 0;
+	for (Triangle t : local ? mesh.unflushedTriangles() : mesh.triangles()) {
+		TriangleHit hit;
+		if (ray.castOnTriangle(PackedTriangle(t), id++, hit))
+			hits.add(hit);
+	}
+
+	hits.finish();
+}
+
+RayHitSet Ray::castOnBvh(const Bvh& bvh) const {
+	HitBuffer hits;
+	castOnBvh(bvh, hits);
+	return RayHitSet{*this, hits};
+}
+
+void Ray::castOnBvh(const Bvh& bvh, HitBuffer& hits) const {
+	hits.clear();
+	collectHits(bvh, hits);
+	hits.finish();
+}
+
+void Ray::collectHits(const Bvh& bvh, HitBuffer& hits) const {
+	if (bvh.isEmpty()) return;
+
+	const std::vector<Bvh::Node>& nodes = bvh.nodes();
+	std::array<unsigned, Bvh::maxDepth + 1> stack;
+	unsigned size = 0;
+	stack[size++] = 0;
+
+	while (size > 0) {
+		const Bvh::Node& node = nodes[stack[--size]];
+
+		Real near, far;
+		if (!castOnBox(node.box, near, far)) continue;
+
+		if (node.isLeaf()) {
+			for (unsigned i = node.first; i < node.first + node.count; ++i) {
+				TriangleHit hit;
+				if (castOnTriangle(bvh.packedTriangles()[i], i, hit))
+					hits.add(hit);
+			}
+		} else {
+			stack[size++] = node.first;
+			stack[size++] = node.first + 1;
+		}
 	}
+}
+
+RayHitSet Ray::castOnInstances(const InstanceBvh& instances) const {
+	if (instances.needsUpdate()) throw std::logic_error("InstanceBvh needs an update");
+
+	HitBuffer hits;
+	const std::vector<Bvh::Node>& nodes = instances.nodes();
+	if (nodes.empty()) return RayHitSet{};
+
+	std::array<unsigned, Bvh::maxDepth + 1> stack;
+	unsigned size = 0;
+	stack[size++] = 0;
+
+	while (size > 0) {
+		const Bvh::Node& node = nodes[stack[--size]];
+
+		Real near, far;
+		if (!castOnBox(node.box, near, far)) continue;
+
+		if (node.isLeaf()) {
+			for (unsigned i = node.first; i < node.first + node.count; ++i) {
+				// The transform is affine, so distances along the local ray are the same as along this one
+				unsigned instance = instances.instances()[i];
+				const Transform& inverse = instances.inverse(instance);
+				Ray local(inverse.apply(_origin), inverse.applyVector(_direction), _tMin, _tMax);
+				local.collectHits(instances.bvh(instance), hits);
+			}
+		} else {
+			stack[size++] = node.first;
+			stack[size++] = node.first + 1;
+		}
+	}
+
+	hits.finish();
+
+	return RayHitSet{*this, hits};
+}
+
+namespace {
+
+/// A node waiting to be visited, and the distance where the ray enters its box.
+struct PendingNode {
+	unsigned node;
+	Real near;
+};
+
+/// \brief Visits the nodes of a tree whose boxes the ray crosses, nearest first, until visitLeaf returns false.
+///
+/// Nodes starting farther than limit are skipped. visitLeaf may lower limit, to prune the rest of the traversal.
+template <typename VisitLeaf>
+void traverse(const Ray& ray, const std::vector<Bvh::Node>& nodes, Real& limit, VisitLeaf visitLeaf) {
+	if (nodes.empty()) return;
+
+	Real near, far;
+	if (!ray.castOnBox(nodes[0].box, near, far)) return;
 
-	hits.removeDuplicates();
+	std::array<PendingNode, Bvh::maxDepth + 1> stack;
+	unsigned size = 0;
+	stack[size++] = {0, near};
+
+	while (size > 0) {
+		PendingNode pending = stack[--size];
+		if (pending.near > limit) continue;
+
+		const Bvh::Node& node = nodes[pending.node];
+		if (node.isLeaf()) {
+			if (!visitLeaf(node)) return;
+			continue;
+		}
+
+		Real nearA, nearB;
+		bool hitA = ray.castOnBox(nodes[node.first].box, nearA, far);
+		bool hitB = ray.castOnBox(nodes[node.first + 1].box, nearB, far);
+
+		// The nearest child is pushed last, so it is visited first
+		if (hitA && hitB && nearA < nearB) {
+			stack[size++] = {node.first + 1, nearB};
+			stack[size++] = {node.first, nearA};
+		} else {
+			if (hitA) stack[size++] = {node.first, nearA};
+			if (hitB) stack[size++] = {node.first + 1, nearB};
+		}
+	}
+}
+
+}
+
+RayHit Ray::castClosest(const Bvh& bvh) const {
+	TriangleHit hit;
+	return castClosest(bvh, hit) ? RayHit{*this, hit.distance} : RayHit{*this};
+}
+
+bool Ray::castClosest(const Bvh& bvh, TriangleHit& hit) const {
+	Real best = _tMax;
+	bool found = false;
+	traverse(*this, bvh.nodes(), best, [&](const Bvh::Node& node) {
+		for (unsigned i = node.first; i < node.first + node.count; ++i) {
+			TriangleHit candidate;
+			if (castOnTriangle(bvh.packedTriangles()[i], i, candidate) && candidate.distance <= best) {
+				best = candidate.distance;
+				hit = candidate;
+				found = true;
+			}
+		}
+		return true;
+	});
+
+	return found;
+}
+
+RayHit Ray::castClosest(const InstanceBvh& instances) const {
+	if (instances.needsUpdate()) throw std::logic_error("InstanceBvh needs an update");
+
+	Real best = _tMax;
+	bool found = false;
+	traverse(*this, instances.nodes(), best, [&](const Bvh::Node& node) {
+		for (unsigned i = node.first; i < node.first + node.count; ++i) {
+			unsigned instance = instances.instances()[i];
+			const Transform& inverse = instances.inverse(instance);
+			Ray local(inverse.apply(_origin), inverse.applyVector(_direction), _tMin, best);
+
+			RayHit hit = local.castClosest(instances.bvh(instance));
+			if (hit.hasHit() && hit.distance() <= best) {
+				best = hit.distance();
+				found = true;
+			}
+		}
+		return true;
+	});
+
+	return found ? RayHit{*this, best} : RayHit{*this};
+}
+
+bool Ray::castAny(const Bvh& bvh) const {
+	Real limit = _tMax;
+	bool found = false;
+	traverse(*this, bvh.nodes(), limit, [&](const Bvh::Node& node) {
+		for (unsigned i = node.first; i < node.first + node.count; ++i) {
+			TriangleHit hit;
+			if (castOnTriangle(bvh.packedTriangles()[i], i, hit)) {
+				found = true;
+				return false;
+			}
+		}
+		return true;
+	});
+
+	return found;
+}
+
+bool Ray::castAny(const InstanceBvh& instances) const {
+	if (instances.needsUpdate()) throw std::logic_error("InstanceBvh needs an update");
+
+	Real limit = _tMax;
+	bool found = false;
+	traverse(*this, instances.nodes(), limit, [&](const Bvh::Node& node) {
+		for (unsigned i = node.first; i < node.first + node.count; ++i) {
+			unsigned instance = instances.instances()[i];
+			const Transform& inverse = instances.inverse(instance);
+			Ray local(inverse.apply(_origin), inverse.applyVector(_direction), _tMin, _tMax);
+
+			if (local.castAny(instances.bvh(instance))) {
+				found = true;
+				return false;
+			}
+		}
+		return true;
+	});
+
+	return found;
+}
+
+unsigned Ray::countHits(const Bvh& bvh) const {
+	std::array<Real, 64> distances;
+	unsigned count = 0;
+	bool overflow = false;
+
+	Real limit = _tMax;
+	traverse(*this, bvh.nodes(), limit, [&](const Bvh::Node& node) {
+		for (unsigned i = node.first; i < node.first + node.count; ++i) {
+			TriangleHit hit;
+			if (!castOnTriangle(bvh.packedTriangles()[i], i, hit)) continue;
+
+			if (count == distances.size()) {
+				overflow = true;
+				return false;
+			}
+			distances[count++] = hit.distance;
+		}
+		return true;
+	});
+
+	if (overflow) {
+		HitBuffer hits;
+		castOnBvh(bvh, hits);
+		return hits.size();
+	}
+
+	// The same as HitBuffer::finish(), on distances alone: every hit closer than duplicateDistance to the
+	// next one is dropped
+	std::sort(distances.begin(), distances.begin() + count);
+
+	unsigned unique = 0;
+	for (unsigned i = 0; i < count; ++i)
+		if (i + 1 == count || distances[i+1] - distances[i] >= RayHitSet::duplicateDistance)
+			++unique;
+
+	return unique;
+}
+
+bool Ray::castOnBox(const BoundingBox& box, Real& near, Real& far) const {
+	if (box.isEmpty()) return false;
+
+	near = std::max(_tMin, Real(0));
+	far = _tMax;
+	if (near > far) return false;
+
+	for (unsigned i = 0; i < 3; ++i) {
+		// A ray parallel to the slab either is always inside it or never is
+		if (_direction(i) == 0) {
+			if (_origin(i) < box.min()(i) || _origin(i) > box.max()(i)) return false;
+			continue;
+		}
+
+		Real inverse = 1 / _direction(i);
+		Real t0 = (box.min()(i) - _origin(i)) * inverse;
+		Real t1 = (box.max()(i) - _origin(i)) * inverse;
+		if (t0 > t1) std::swap(t0, t1);
+
+		near = std::max(near, t0);
+		far = std::min(far, t1);
+		if (near > far) return false;
+	}
 
-	return hits;
+	return true;
 }
@@ -0,0 +1,45 @@
+#include <geometry/RayCaster>
+#include <geometry/Bvh>
+#include <geometry/TriangleHit>
+
+using namespace geometry;
+using namespace math;
+
+constexpr std::size_t RayCaster::grain;
+
+RayCaster::RayCaster(unsigned threads)
+	: _pool(threads) {
+
+}
+
+unsigned RayCaster::threads() const {
+	return _pool.size();
+}
+
+void RayCaster::cast(const Bvh& bvh, const Ray* rays, std::size_t count, Query query, Result* results) {
+	_pool.parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i) {
+			Result& result = results[i];
+			result = Result{false, 0, 0, 0};
+
+			switch (query) {
+			case Query::Closest: {
+				TriangleHit hit;
+				if (rays[i].castClosest(bvh, hit)) {
+					result.hit = true;
+					result.distance = hit.distance;
+					result.triangle = hit.triangle;
+				}
+				break;
+			}
+			case Query::Any:
+				result.hit = rays[i].castAny(bvh);
+				break;
+			case Query::Count:
+				result.count = rays[i].countHits(bvh);
+				result.hit = result.count > 0;
+				break;
+			}
+		}
+	});
+}
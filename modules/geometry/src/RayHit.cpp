@@ -4,6 +4,9 @@
 using namespace geometry;
 using namespace math;
 
+constexpr Real RayHit::minimumDistance;
+constexpr Real RayHit::edgeTolerance;
+
 RayHit::RayHit(Ray ray)
 	: _ray(ray), _hasHit(false) {
 
@@ -11,7 +14,7 @@ RayHit::RayHit(Ray ray)
 
 RayHit::RayHit(Ray ray, math::Real distance)
 	: _ray(ray), _distance(distance), _hasHit(true) {
-	if (distance < 0.000001) { // FIXME
+	if (distance < minimumDistance) {
 		_hasHit = false;
 	}
 }
@@ -1,16 +1,48 @@
 #include <geometry/RayHitSet>
+#include <geometry/HitBuffer>
 #include <algorithm>
+#include <cmath>
 
 using namespace geometry;
 
+constexpr math::Real RayHitSet::duplicateDistance;
+
+RayHitSet::RayHitSet(const Ray& ray, const HitBuffer& hits) {
+	_hits.reserve(hits.size());
+	for (const TriangleHit& hit : hits)
+		_hits.push_back(RayHit{ray, hit.distance});
+}
+
+bool RayHitSet::insert(const RayHit& hit) {
+	auto it = std::lower_bound(_hits.begin(), _hits.end(), hit);
+	if (it != _hits.end() && !(hit < *it)) return false;
+
+	_hits.insert(it, hit);
+	return true;
+}
+
 void RayHitSet::removeDuplicates() {
-	auto cmp = [](const RayHit& a, const RayHit& b){
-		auto dist = std::abs(a.distance() - b.distance());
-		return dist < 0.000001; // TODO
-	};
-
-	auto it = begin();
-	while ((it = std::adjacent_find(it, end(), cmp)) != end()) {
-		erase(it);
-	}
+	// A hit is dropped when the next one is too close. The next one is always read before being moved.
+	std::size_t kept = 0;
+	for (std::size_t i = 0; i < _hits.size(); ++i)
+		if (i + 1 == _hits.size() || std::abs(_hits[i+1].distance() - _hits[i].distance()) >= duplicateDistance)
+			_hits[kept++] = _hits[i];
+
+	_hits.erase(_hits.begin() + kept, _hits.end());
+}
+
+std::size_t RayHitSet::size() const {
+	return _hits.size();
+}
+
+bool RayHitSet::empty() const {
+	return _hits.empty();
+}
+
+RayHitSet::const_iterator RayHitSet::begin() const {
+	return _hits.begin();
+}
+
+RayHitSet::const_iterator RayHitSet::end() const {
+	return _hits.end();
 }
@@ -0,0 +1,250 @@
+#include <geometry/RayPacket>
+#include <geometry/RayHit>
+#include <geometry/Bvh>
+#include <geometry/BoundingBox>
+#include <geometry/PackedTriangle>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace geometry;
+using namespace math;
+
+namespace simd = math::simd;
+
+template <unsigned W>
+constexpr unsigned RayPacket<W>::width;
+
+template <unsigned W>
+RayPacket<W>::RayPacket(const Ray* rays, unsigned count)
+	: _rays(rays, rays + count), _active(0), _degenerate(0), _uniform(true) {
+	if (count > W) throw std::logic_error("too many rays for a packet");
+
+	for (unsigned lane = 0; lane < W; ++lane) {
+		// Idle lanes repeat the first ray, or a harmless one, so they don't break the uniform case
+		const Ray& ray = lane < count ? rays[lane] : count > 0 ? rays[0] : Ray({0, 0, 0}, {0, 0, 1});
+		if (lane < count) _active |= 1u << lane;
+
+		for (unsigned i = 0; i < 3; ++i) {
+			_origin[i][lane] = ray._origin(i);
+			_direction[i][lane] = ray._direction(i);
+			_inverse[i][lane] = 1 / ray._direction(i);
+		}
+		_near[lane] = std::max(ray._tMin, Real(0));
+		_tMin[lane] = ray._tMin;
+		_tMax[lane] = ray._tMax;
+
+		_axes[0][lane] = ray._kx;
+		_axes[1][lane] = ray._ky;
+		_axes[2][lane] = ray._kz;
+		_shear[0][lane] = ray._shearX;
+		_shear[1][lane] = ray._shearY;
+		_shear[2][lane] = ray._shearZ;
+		for (unsigned i = 0; i < 3; ++i) {
+			_sheared[i][lane] = ray._origin(_axes[i][lane]);
+			_uniform = _uniform && _axes[i][lane] == _axes[i][0];
+		}
+
+		if (ray._direction(ray._kz) == 0) _degenerate |= 1u << lane;
+	}
+}
+
+template <unsigned W>
+unsigned RayPacket<W>::size() const {
+	return _rays.size();
+}
+
+template <unsigned W>
+const Ray& RayPacket<W>::ray(unsigned lane) const {
+	return _rays[lane];
+}
+
+template <unsigned W>
+unsigned RayPacket<W>::active() const {
+	return _active;
+}
+
+template <unsigned W>
+unsigned RayPacket<W>::castOnBox(const BoundingBox& box, unsigned mask) const {
+	mask &= _active;
+	if (mask == 0 || box.isEmpty()) return 0;
+
+	unsigned result = 0;
+	for (unsigned p = 0; p < W; p += simd::width) {
+		if (((mask >> p) & simd::allBits) == 0) continue;
+
+		simd::Pack near = simd::load(&_near[p]);
+		simd::Pack far = simd::load(&_tMax[p]);
+		simd::Mask miss = near > far;
+
+		for (unsigned i = 0; i < 3; ++i) {
+			simd::Pack origin = simd::load(&_origin[i][p]);
+			simd::Pack min = simd::broadcast(box.min()(i));
+			simd::Pack max = simd::broadcast(box.max()(i));
+
+			// Lanes parallel to the slab keep their range, and miss if they are outside it
+			simd::Mask parallel = simd::load(&_direction[i][p]) == simd::broadcast(0);
+			miss = miss | (parallel & ((origin < min) | (origin > max)));
+
+			simd::Pack inverse = simd::load(&_inverse[i][p]);
+			simd::Pack t0 = (min - origin) * inverse;
+			simd::Pack t1 = (max - origin) * inverse;
+			simd::Mask swap = t0 > t1;
+			simd::Pack low = simd::select(swap, t1, t0);
+			simd::Pack high = simd::select(swap, t0, t1);
+
+			// The same choices as std::max and std::min
+			near = simd::select(parallel, near, simd::select(near < low, low, near));
+			far = simd::select(parallel, far, simd::select(high < far, high, far));
+			miss = miss | (near > far);
+		}
+
+		result |= (simd::bits(miss) ^ simd::allBits) << p;
+	}
+
+	return result & mask;
+}
+
+template <unsigned W>
+unsigned RayPacket<W>::castOnTriangle(const PackedTriangle& triangle, unsigned id, unsigned mask,
+	std::array<TriangleHit, W>& hits) const {
+	mask &= _active & ~_degenerate;
+	if (mask == 0) return 0;
+
+	// The vertices along the axes of each lane. With uniform axes they are the same for all lanes.
+	std::array<std::array<Lanes, 3>, 3> vertices;
+	if (!_uniform) {
+		for (unsigned v = 0; v < 3; ++v)
+			for (unsigned i = 0; i < 3; ++i)
+				for (unsigned lane = 0; lane < W; ++lane)
+					vertices[v][i][lane] = triangle.vertices[v](_axes[i][lane]);
+	}
+
+	unsigned result = 0;
+	Lanes distance, u, v;
+	for (unsigned p = 0; p < W; p += simd::width) {
+		if (((mask >> p) & simd::allBits) == 0) continue;
+
+		// The same steps as Ray::castOnTriangle(), which explains them
+		std::array<std::array<simd::Pack, 3>, 3> relative;
+		for (unsigned k = 0; k < 3; ++k)
+			for (unsigned i = 0; i < 3; ++i) {
+				simd::Pack coordinate = _uniform
+					? simd::broadcast(triangle.vertices[k](_axes[i][0]))
+					: simd::load(&vertices[k][i][p]);
+				relative[k][i] = coordinate - simd::load(&_sheared[i][p]);
+			}
+
+		simd::Pack shearX = simd::load(&_shear[0][p]);
+		simd::Pack shearY = simd::load(&_shear[1][p]);
+		simd::Pack shearZ = simd::load(&_shear[2][p]);
+
+		const simd::Pack ax = relative[0][0] - shearX * relative[0][2];
+		const simd::Pack ay = relative[0][1] - shearY * relative[0][2];
+		const simd::Pack bx = relative[1][0] - shearX * relative[1][2];
+		const simd::Pack by = relative[1][1] - shearY * relative[1][2];
+		const simd::Pack cx = relative[2][0] - shearX * relative[2][2];
+		const simd::Pack cy = relative[2][1] - shearY * relative[2][2];
+
+		const simd::Pack uu = cx * by - cy * bx;
+		const simd::Pack vv = ax * cy - ay * cx;
+		const simd::Pack ww = bx * ay - by * ax;
+
+		const simd::Pack tolerance = simd::broadcast(RayHit::edgeTolerance);
+		const simd::Pack tu = tolerance * (simd::abs(cx * by) + simd::abs(cy * bx));
+		const simd::Pack tv = tolerance * (simd::abs(ax * cy) + simd::abs(ay * cx));
+		const simd::Pack tw = tolerance * (simd::abs(bx * ay) + simd::abs(by * ax));
+
+		simd::Mask front = (uu >= -tu) & (vv >= -tv) & (ww >= -tw);
+		simd::Mask back = (uu <= tu) & (vv <= tv) & (ww <= tw);
+
+		const simd::Pack det = uu + vv + ww;
+
+		const simd::Pack az = shearZ * relative[0][2];
+		const simd::Pack bz = shearZ * relative[1][2];
+		const simd::Pack cz = shearZ * relative[2][2];
+		const simd::Pack t = (uu * az + vv * bz + ww * cz) / det;
+
+		simd::Mask hit = (front | back) & (det != simd::broadcast(0))
+			& (t >= simd::load(&_tMin[p])) & (t >= simd::broadcast(RayHit::minimumDistance)) & (t <= simd::load(&_tMax[p]));
+
+		unsigned bits = simd::bits(hit) & (mask >> p);
+		if (bits == 0) continue;
+
+		simd::store(&distance[p], t);
+		simd::store(&u[p], vv / det);
+		simd::store(&v[p], ww / det);
+		result |= bits << p;
+	}
+
+	for (unsigned lane = 0; lane < W; ++lane) {
+		if (!(result & (1u << lane))) continue;
+		hits[lane].distance = distance[lane];
+		hits[lane].u = u[lane];
+		hits[lane].v = v[lane];
+		hits[lane].triangle = id;
+	}
+
+	return result;
+}
+
+template <unsigned W>
+std::array<RayHitSet, W> RayPacket<W>::castOnBvh(const Bvh& bvh) const {
+	std::array<HitBuffer, W> hits;
+	castOnBvh(bvh, hits);
+
+	std::array<RayHitSet, W> sets;
+	for (unsigned lane = 0; lane < size(); ++lane)
+		sets[lane] = RayHitSet{_rays[lane], hits[lane]};
+
+	return sets;
+}
+
+template <unsigned W>
+void RayPacket<W>::castOnBvh(const Bvh& bvh, std::array<HitBuffer, W>& hits) const {
+	for (HitBuffer& buffer : hits)
+		buffer.clear();
+	if (bvh.isEmpty() || _active == 0) return;
+
+	// Each node is visited with the lanes that reached it, so every lane visits the nodes its Ray would
+	struct Pending {
+		unsigned node;
+		unsigned mask;
+	};
+
+	const std::vector<Bvh::Node>& nodes = bvh.nodes();
+	std::array<Pending, Bvh::maxDepth + 1> stack;
+	unsigned size = 0;
+	stack[size++] = {0, _active};
+
+	std::array<TriangleHit, W> laneHits;
+	while (size > 0) {
+		Pending pending = stack[--size];
+		const Bvh::Node& node = nodes[pending.node];
+
+		unsigned mask = castOnBox(node.box, pending.mask);
+		if (mask == 0) continue;
+
+		if (node.isLeaf()) {
+			for (unsigned i = node.first; i < node.first + node.count; ++i) {
+				unsigned hit = castOnTriangle(bvh.packedTriangles()[i], i, mask, laneHits);
+				for (unsigned lane = 0; hit != 0; ++lane, hit >>= 1)
+					if (hit & 1)
+						hits[lane].add(laneHits[lane]);
+			}
+		} else {
+			stack[size++] = {node.first, mask};
+			stack[size++] = {node.first + 1, mask};
+		}
+	}
+
+	for (HitBuffer& buffer : hits)
+		buffer.finish();
+}
+
+namespace geometry {
+
+template class RayPacket<4>;
+template class RayPacket<8>;
+
+}
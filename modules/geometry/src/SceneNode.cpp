@@ -0,0 +1,74 @@
+#include <geometry/SceneNode>
+#include <stdexcept>
+
+using namespace geometry;
+
+SceneNode::SceneNode(const Transform& local)
+	: SceneNode(nullptr, local) {
+
+}
+
+SceneNode::SceneNode(SceneNode* parent, const Transform& local)
+	: _parent(parent), _local(local), _dirty(true) {
+
+}
+
+SceneNode& SceneNode::addChild(const Transform& local) {
+	// The constructor is private, so make_unique can't reach it
+	_children.emplace_back(new SceneNode(this, local));
+	return *_children.back();
+}
+
+SceneNode* SceneNode::parent() const {
+	return _parent;
+}
+
+std::size_t SceneNode::size() const {
+	return _children.size();
+}
+
+SceneNode& SceneNode::child(std::size_t i) const {
+	if (i >= _children.size()) throw std::logic_error("SceneNode has no such child");
+	return *_children[i];
+}
+
+const Transform& SceneNode::local() const {
+	return _local;
+}
+
+void SceneNode::setLocal(const Transform& local) {
+	_local = local;
+	markDirty();
+}
+
+void SceneNode::markDirty() {
+	// A dirty node only has dirty descendants, so there is nothing to do below it
+	if (_dirty) return;
+	_dirty = true;
+	for (const std::unique_ptr<SceneNode>& child : _children)
+		child->markDirty();
+}
+
+const Transform& SceneNode::world() const {
+	if (_dirty) {
+		_world = _parent ? _parent->world() * _local : _local;
+		_dirty = false;
+	}
+	return _world;
+}
+
+bool SceneNode::dirty() const {
+	return _dirty;
+}
+
+void SceneNode::update() const {
+	// A clean node can still have dirty descendants, so the whole subtree is walked
+	world();
+
+	// Fills the inverse cache of the world transform, so later readers don't write it. A no-op once it is filled
+	Transform inverse;
+	_world.tryInverse(inverse);
+
+	for (const std::unique_ptr<SceneNode>& child : _children)
+		child->update();
+}
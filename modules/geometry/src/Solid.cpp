@@ -1,41 +1,50 @@
 #include <geometry/Solid>
 #include <geometry/Ray>
 #include <geometry/RayHit>
+#include <geometry/Bvh>
+#include <geometry/StaticMesh>
 #include <math/Matrix>
 
-#include <cmath>
+#include <stdexcept>
 
 using namespace math;
 using namespace geometry;
 
 
 void Solid::orient() {
+	// Flipping a face doesn't move its vertices, so the same Bvh serves every face
+	Bvh bvh(*this);
 	for (Triangle face : triangles()) {
 		Ray ray{face.position(), face.normal()};
-		if (ray.castOnMesh(*this).size() % 2 == 1)
+		if (ray.countHits(bvh) % 2 == 1)
 			face.changeOrientation();
 	}
 }
 
 Real Solid::volume() const {
-	Real volume = 0;
+	// The terms of large meshes mostly cancel out, so they are summed in Accumulator precision
+	using Wide = Vector<3, Accumulator>;
+	
+	Accumulator volume = 0;
 	for (Triangle face : triangles()) {
-		Vector3 e1 = face.vertices()[1].position() - face.vertices()[0].position();
-		Vector3 e2 = face.vertices()[2].position() - face.vertices()[1].position();
-		Vector3 r1 = face.vertices()[0].position();
-		Vector3 r2 = face.vertices()[1].position();
-
-		Vector3 value = r1 + r2 + (e1 + e2) / 2.0;
-		volume += value.dot(face.vectorArea());
+		Wide r1(face.vertices()[0].position());
+		Wide r2(face.vertices()[1].position());
+		Wide r3(face.vertices()[2].position());
+		Wide e1 = r2 - r1;
+		Wide e2 = r3 - r2;
+
+		Wide value = r1 + r2 + (e1 + e2) / 2.0;
+		volume += value.dot(Wide(face.vectorArea()));
 	}
 	
-	return volume / 6.0;
+	return Real(volume / 6.0);
 }
 
 Vector3 Solid::center() const {
-	Vector3 center;
-	for (const Vertex& v : vertices()) center += v.position();
-	return center / vertices().size();
+	Vector<3, Accumulator> center;
+	for (const Vertex& v : vertices()) center += Vector<3, Accumulator>(v.position());
+	center /= Accumulator(vertices().size());
+	return Vector3(center);
 }
 
 void Solid::centralize() {
@@ -44,98 +53,20 @@ void Solid::centralize() {
 }
 
 Solid Solid::cone(unsigned sides) {
-	if (sides < 3) throw std::logic_error("Invalid number of sides");
-	
-	Solid cone;
-	
-	if (sides == 3) {
-		// Base vertex
-		Vertex v1 = cone.addVertex({0, 0, 0});
-		Vertex v2 = cone.addVertex({0.5, sqrt(3) / 2.0, 0});
-		Vertex v3 = cone.addVertex({1, 0, 0});
-		
-		// Base edge
-		Edge e12 = cone.addEdge(v1, v2);
-		Edge e23 = cone.addEdge(v2, v3);
-		Edge e13 = cone.addEdge(v1, v3);
-		
-		// Top vertex
-		Vertex top = cone.addVertex({1/2, 1/3, sqrt(1 - 1/4 - 1/9)});
-		Edge e14 = cone.addEdge(v1, top);
-		Edge e24 = cone.addEdge(v2, top);
-		Edge e34 = cone.addEdge(v3, top);
-		
-		// Triangles
-		cone.addTriangle(e12, e23, e13);
-		cone.addTriangle(e13, e34, e14);
-		cone.addTriangle(e12, e24, e14);
-		cone.addTriangle(e23, e34, e24);
-		
-		cone.centralize();
-		return cone;
+	// The geometry is a constant for each number of sides, so only the Mesh itself is built here
+	switch (sides) {
+		case 3: return staticCone<3>().toSolid();
+		case 4: return staticCone<4>().toSolid();
+		case 5: return staticCone<5>().toSolid();
+		case 6: return staticCone<6>().toSolid();
+		case 7: return staticCone<7>().toSolid();
+		case 8: return staticCone<8>().toSolid();
+		default: throw std::logic_error("Invalid number of sides");
 	}
-	
-	else throw "Not implemented";
 }
 
 Solid Solid::cube() {
-	Solid cube;
-
-	// Cube Vertices
-	Vertex v1 = cube.addVertex({0, 0, 0});
-	Vertex v2 = cube.addVertex({0, 0, 1});
-	Vertex v3 = cube.addVertex({0, 1, 1});
-	Vertex v4 = cube.addVertex({0, 1, 0});
-	Vertex v5 = cube.addVertex({1, 0, 0});
-	Vertex v6 = cube.addVertex({1, 0, 1});
-	Vertex v7 = cube.addVertex({1, 1, 1});
-	Vertex v8 = cube.addVertex({1, 1, 0});
-
-	// Base
-	Edge e12 = cube.addEdge(v1, v2);
-	Edge e23 = cube.addEdge(v2, v3);
-	Edge e34 = cube.addEdge(v3, v4);
-	Edge e14 = cube.addEdge(v1, v4);
-	Edge e13 = cube.addEdge(v1, v3);
-
-	// Top
-	Edge e56 = cube.addEdge(v5, v6);
-	Edge e67 = cube.addEdge(v6, v7);
-	Edge e78 = cube.addEdge(v7, v8);
-	Edge e58 = cube.addEdge(v5, v8);
-	Edge e57 = cube.addEdge(v5, v7);
-
-	// Vertical Sides
-	Edge e15 = cube.addEdge(v1, v5);
-	Edge e26 = cube.addEdge(v2, v6);
-	Edge e37 = cube.addEdge(v3, v7);
-	Edge e48 = cube.addEdge(v4, v8);
-
-	// Cross Sides
-	Edge e16 = cube.addEdge(v1, v6);
-	Edge e27 = cube.addEdge(v2, v7);
-	Edge e38 = cube.addEdge(v3, v8);
-	Edge e45 = cube.addEdge(v4, v5);
-
-	// Bottom
-	cube.addTriangle(e12, e23, e13);
-	cube.addTriangle(e13, e34, e14);
-	// Top
-	cube.addTriangle(e56, e67, e57);
-	cube.addTriangle(e57, e78, e58);
-	// Right
-	cube.addTriangle(e12, e26, e16);
-	cube.addTriangle(e56, e15, e16);
-	// Left
-	cube.addTriangle(e34, e48, e38);
-	cube.addTriangle(e78, e37, e38);
-	// Front
-	cube.addTriangle(e23, e37, e27);
-	cube.addTriangle(e67, e26, e27);
-	// Back
-	cube.addTriangle(e14, e15, e45);
-	cube.addTriangle(e58, e48, e45);
-	
-	cube.centralize();
-	return cube;
+	// The geometry is a constant, so only the Mesh itself is built here
+	constexpr StaticMesh<8, 12> cube = staticCube();
+	return cube.toSolid();
 }
@@ -1,71 +1,203 @@
 #include <geometry/Transform>
 #include <math/Vector>
 #include <cmath>
+#include <stdexcept>
 
+using math::Matrix;
+using math::Matrix3;
 using math::Matrix4;
+using math::Quaternion;
 using math::Real;
+using math::ThreadPool;
 using math::Vector3;
-using math::Vector4;
+using math::VectorArray;
 using geometry::Transform;
 
 Transform::Transform() {
 	clear();
 }
 
+Transform::Transform(const Vector3& translation, const Quaternion& rotation, const Vector3& scale) {
+	_linear = rotation.unit().matrix();
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			_linear(i, j) *= scale(j);
+	_translation = translation;
+	_rotated = false;
+	_inverseState = InverseState::Unknown;
+}
+
+void Transform::flush() {
+	if (!_rotated) return;
+	_linear *= _rotation.unit().matrix();
+	_rotation = Quaternion();
+	_rotated = false;
+}
+
+bool Transform::computeInverse() const {
+	if (_inverseState == InverseState::Unknown) {
+		// The inverse of [A t] is [A^-1 -A^-1*t], so only the linear part is inverted
+		Matrix3 inverse;
+		if (linear().tryInverse(inverse)) {
+			_inverseLinear = inverse;
+			_inverseTranslation = -(inverse * _translation);
+			_inverseState = InverseState::Valid;
+		} else {
+			_inverseState = InverseState::Singular;
+		}
+	}
+	return _inverseState == InverseState::Valid;
+}
+
 void Transform::scale(math::Real scale) {
-	Matrix4 sub = scale * Matrix4::eye();
-	sub(15) = 1;
-	_transform *= sub;
+	// A uniform scaling commutes with the pending rotation
+	_linear *= scale;
+	_inverseState = InverseState::Unknown;
 }
 
 void Transform::scale(const Vector3& scale) {
-	Matrix4 sub = Matrix4::eye();
-	for (int i = 0; i < 3; ++i) sub(5*i) = scale(i);
-	_transform *= sub;
+	flush();
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			_linear(i, j) *= scale(j);
+	_inverseState = InverseState::Unknown;
 }
 
 void Transform::translate(const Vector3& translate) {
-	Matrix4 sub = Matrix4::eye();
-	for (int i = 0; i < 3; ++i) sub(4*i+3) = translate(i);
-	_transform *= sub;
+	// The pending rotation stays after the translation, once it is taken through it
+	_translation += applyVector(translate);
+	_inverseState = InverseState::Unknown;
 }
 
 void Transform::rotateX(const math::Real& angle) {
-	Matrix4 sub = Matrix4::eye();
-	Real c = std::cos(angle);
-	Real s = std::sin(angle);
-	sub(5) = c; sub(6) = -s;
-	sub(9) = s; sub(10) = c;
-	
-	_transform *= sub;
+	rotate(Quaternion::rotationX(angle));
 }
 
 void Transform::rotateY(const math::Real& angle) {
-	Matrix4 sub = Matrix4::eye();
-	Real c = std::cos(angle);
-	Real s = std::sin(angle);
-	sub(0) = c; sub(2) = s;
-	sub(8) = -s; sub(10) = c;
-	
-	_transform *= sub;
+	rotate(Quaternion::rotationY(angle));
 }
 
 void Transform::rotateZ(const math::Real& angle) {
-	Matrix4 sub = Matrix4::eye();
-	Real c = std::cos(angle);
-	Real s = std::sin(angle);
-	sub(0) = c; sub(1) = -s;
-	sub(4) = s; sub(5) = c;
-	
-	_transform *= sub;
+	rotate(Quaternion::rotationZ(angle));
 }
 
-Vector3 Transform::apply(const Vector3& point) const {
-	Vector4 p(point, 1);
-	Vector4 result = _transform * p;
-	return result.subvector<3>();
+void Transform::rotate(const Quaternion& rotation) {
+	// Products of unit quaternions drift from unit, which rotate() in applyVector() would take as a scaling
+	_rotation *= rotation;
+	_rotation.normalize();
+	_rotated = true;
+	_inverseState = InverseState::Unknown;
 }
 
 void Transform::clear() {
-	_transform = Matrix4::eye();
+	_linear = Matrix3::eye();
+	_translation = {0, 0, 0};
+	_rotation = Quaternion();
+	_rotated = false;
+	_inverseState = InverseState::Unknown;
+}
+
+Transform Transform::operator*(const Transform& other) const {
+	Transform result = *this;
+	result *= other;
+	return result;
+}
+
+Transform& Transform::operator*=(const Transform& other) {
+	// [A t] * [B u] = [A*B t+A*u], and the pending rotation of other stays pending
+	_translation += applyVector(other._translation);
+	flush();
+	_linear *= other._linear;
+	_rotation = other._rotation;
+	_rotated = other._rotated;
+	_inverseState = InverseState::Unknown;
+	return *this;
+}
+
+Vector3 Transform::apply(const Vector3& point) const {
+	return applyVector(point) + _translation;
+}
+
+Vector3 Transform::applyVector(const Vector3& vector) const {
+	if (_rotated) return _linear * _rotation.rotate(vector);
+	return _linear * vector;
+}
+
+void Transform::apply(const VectorArray<3>& points, VectorArray<3>& out, ThreadPool* pool) const {
+	points.transformPoints(affine(), out, pool);
+}
+
+void Transform::applyVector(const VectorArray<3>& vectors, VectorArray<3>& out, ThreadPool* pool) const {
+	vectors.transformVectors(affine(), out, pool);
+}
+
+void Transform::applyNormal(const VectorArray<3>& normals, VectorArray<3>& out, ThreadPool* pool) const {
+	normals.transformNormals(linear(), out, pool);
+}
+
+Transform Transform::inverse() const {
+	Transform result;
+	if (!tryInverse(result)) throw std::logic_error("Transform is not invertible");
+	return result;
+}
+
+bool Transform::tryInverse(Transform& result) const {
+	if (!computeInverse()) return false;
+	result.clear();
+	result._linear = _inverseLinear;
+	result._translation = _inverseTranslation;
+
+	// The inverse of the inverse is known already
+	result._inverseLinear = linear();
+	result._inverseTranslation = _translation;
+	result._inverseState = InverseState::Valid;
+	return true;
+}
+
+void Transform::decompose(Vector3& translation, Quaternion& rotation, Vector3& scale) const {
+	if (!computeInverse()) throw std::logic_error("Transform is not invertible");
+
+	// Each column of the linear part is a column of the rotation, times the scale along it
+	Matrix3 columns = linear();
+	Vector3 lengths;
+	for (unsigned j = 0; j < 3; ++j)
+		lengths(j) = Vector3(columns(0, j), columns(1, j), columns(2, j)).length();
+
+	if (columns.det() < 0) lengths(0) = -lengths(0);
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			columns(i, j) /= lengths(j);
+
+	translation = _translation;
+	rotation = Quaternion::fromMatrix(columns);
+	scale = lengths;
+}
+
+Matrix3 Transform::linear() const {
+	if (_rotated) return _linear * _rotation.unit().matrix();
+	return _linear;
+}
+
+const Vector3& Transform::translation() const {
+	return _translation;
+}
+
+Matrix<3, 4> Transform::affine() const {
+	Matrix3 l = linear();
+	Matrix<3, 4> result;
+	for (unsigned i = 0; i < 3; ++i) {
+		for (unsigned j = 0; j < 3; ++j)
+			result(i, j) = l(i, j);
+		result(i, 3) = _translation(i);
+	}
+	return result;
+}
+
+Matrix4 Transform::matrix() const {
+	Matrix<3, 4> a = affine();
+	Matrix4 result = Matrix4::eye();
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 4; ++j)
+			result(i, j) = a(i, j);
+	return result;
 }
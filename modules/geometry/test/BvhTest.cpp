@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <set>
+#include <vector>
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/ThreadPool>
+#include <geometry/Mesh>
+#include <geometry/Solid>
+#include <geometry/Vertex>
+#include <geometry/Triangle>
+#include <geometry/BoundingBox>
+#include <geometry/Bvh>
+#include <geometry/Transform>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+
+#include "Helpers.hpp"
+
+using namespace math;
+using namespace geometry;
+
+static bool boxContains(const BoundingBox& outer, const BoundingBox& inner) {
+	return outer.contains(inner.min()) && outer.contains(inner.max());
+}
+
+/// Checks that two trees are the same, regardless of the order their nodes are stored in.
+static void expectSameTree(const Bvh& a, unsigned nodeA, const Bvh& b, unsigned nodeB) {
+	const Bvh::Node& na = a.nodes()[nodeA];
+	const Bvh::Node& nb = b.nodes()[nodeB];
+	ASSERT_EQ(na.isLeaf(), nb.isLeaf());
+	EXPECT_TRUE(na.box.min() == nb.box.min());
+	EXPECT_TRUE(na.box.max() == nb.box.max());
+
+	if (na.isLeaf()) {
+		ASSERT_EQ(na.count, nb.count);
+		for (unsigned i = 0; i < na.count; ++i)
+			EXPECT_EQ(a.triangles()[na.first + i], b.triangles()[nb.first + i]);
+	} else {
+		expectSameTree(a, na.first, b, nb.first);
+		expectSameTree(a, na.first + 1, b, nb.first + 1);
+	}
+}
+
+TEST(BoundingBox, Extend) {
+	BoundingBox box;
+	EXPECT_TRUE(box.isEmpty());
+	EXPECT_DOUBLE_EQ(0, box.area());
+
+	box.extend(Vector3{1, 2, 3});
+	EXPECT_FALSE(box.isEmpty());
+	EXPECT_DOUBLE_EQ(0, box.area());
+
+	box.extend(Vector3{2, 4, 6});
+	EXPECT_DOUBLE_EQ(2 * (1*2 + 2*3 + 3*1), box.area());
+	EXPECT_EQ(2u, box.largestAxis());
+	EXPECT_TRUE(box.contains({1.5, 3, 3}));
+	EXPECT_FALSE(box.contains({1.5, 3, 7}));
+}
+
+TEST(Bvh, EmptyMesh) {
+	Mesh mesh;
+	Bvh bvh(mesh);
+
+	EXPECT_TRUE(bvh.isEmpty());
+	EXPECT_EQ(0u, Ray({0, 0, 0}, {1, 0, 0}).castOnBvh(bvh).size());
+}
+
+/// Checks that every node bounds its triangles and children.
+static void expectBounding(const Bvh& bvh) {
+	for (const Bvh::Node& node : bvh.nodes()) {
+		if (node.isLeaf()) {
+			for (unsigned i = node.first; i < node.first + node.count; ++i)
+				for (const Vertex& v : bvh.triangles()[i].vertices())
+					EXPECT_TRUE(node.box.contains(v.position()));
+		} else {
+			EXPECT_TRUE(boxContains(node.box, bvh.nodes()[node.first].box));
+			EXPECT_TRUE(boxContains(node.box, bvh.nodes()[node.first + 1].box));
+		}
+	}
+}
+
+TEST(Bvh, Structure) {
+	Mesh mesh = terrain(20);
+	Bvh bvh(mesh);
+
+	ASSERT_FALSE(bvh.isEmpty());
+	EXPECT_EQ(mesh.triangles().size(), bvh.triangles().size());
+
+	std::set<Triangle> unique(bvh.triangles().begin(), bvh.triangles().end());
+	EXPECT_EQ(mesh.triangles(), unique);
+
+	unsigned referenced = 0;
+	for (const Bvh::Node& node : bvh.nodes()) {
+		if (node.isLeaf()) referenced += node.count;
+		else ASSERT_LT(node.first + 1, bvh.nodes().size());
+	}
+
+	expectBounding(bvh);
+	EXPECT_EQ(bvh.triangles().size(), referenced);
+}
+
+TEST(Bvh, CastMatchesMesh) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh);
+
+	// Vertical rays, many of them crossing exactly through vertices and edges
+	for (unsigned i = 0; i <= 24; ++i)
+		for (unsigned j = 0; j <= 24; ++j) {
+			Ray ray({i * 0.5, j * 0.5, 5}, {0, 0, -1});
+			expectSameHits(ray.castOnMesh(mesh), ray.castOnBvh(bvh));
+		}
+
+	// Grazing rays that cross many triangles
+	for (unsigned i = 0; i < 30; ++i) {
+		Real angle = i * 0.21;
+		Ray ray({6, 6, 0.1}, {std::cos(angle), std::sin(angle), 0.01 * (i % 5) - 0.02});
+		expectSameHits(ray.castOnMesh(mesh), ray.castOnBvh(bvh));
+	}
+}
+
+TEST(Bvh, CastOnSolid) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+
+	Ray through({-2, 0.1, 0.2}, {1, 0, 0});
+	expectSameHits(through.castOnMesh(cube), through.castOnBvh(bvh));
+	EXPECT_EQ(2u, through.castOnBvh(bvh).size());
+
+	Ray diagonal({-1, -1, -1}, {1, 1, 1});
+	expectSameHits(diagonal.castOnMesh(cube), diagonal.castOnBvh(bvh));
+
+	Ray away({-2, 0, 0}, {-1, 0, 0});
+	EXPECT_EQ(0u, away.castOnBvh(bvh).size());
+}
+
+TEST(Bvh, FastQualityCastMatchesMesh) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh, Bvh::Quality::Fast);
+	EXPECT_EQ(mesh.triangles().size(), bvh.triangles().size());
+
+	for (unsigned i = 0; i <= 24; ++i)
+		for (unsigned j = 0; j <= 24; ++j) {
+			Ray ray({i * 0.5, j * 0.5, 5}, {0.1, -0.05, -1});
+			expectSameHits(ray.castOnMesh(mesh), ray.castOnBvh(bvh));
+		}
+}
+
+TEST(Bvh, ThreadCountDoesNotChangeTree) {
+	// Big enough for the top nodes to be binned and partitioned in parallel
+	Mesh mesh = terrain(100);
+
+	ThreadPool pool(4);
+	for (Bvh::Quality quality : {Bvh::Quality::Fast, Bvh::Quality::High}) {
+		Bvh serial(mesh, quality);
+		Bvh parallel(mesh, quality, &pool);
+
+		EXPECT_EQ(serial.nodes().size(), parallel.nodes().size());
+		expectSameTree(serial, 0, parallel, 0);
+
+		Ray ray({95.3, 20.1, 3}, {-0.2, 1, -0.01});
+		expectSameHits(ray.castOnBvh(serial), ray.castOnBvh(parallel));
+	}
+}
+
+TEST(Bvh, RefitAfterApply) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+
+	Transform transform;
+	transform.translate({3, 0, 0});
+	transform.scale({1, 2, 3});
+	cube.apply(transform);
+	bvh.refit();
+	expectBounding(bvh);
+
+	EXPECT_DOUBLE_EQ(3, bvh.bounds().center().x());
+
+	Ray ray({0, 0.1, 0.2}, {1, 0, 0});
+	expectSameHits(ray.castOnMesh(cube), ray.castOnBvh(bvh));
+	EXPECT_EQ(2u, ray.castOnBvh(bvh).size());
+}
+
+TEST(Bvh, RefitTouched) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh);
+
+	// Raise a few vertices into a spike
+	std::vector<Vertex> moved;
+	for (Vertex v : mesh.vertices()) {
+		Vector3 p = v.position();
+		if (std::abs(p.x() - 6) <= 1 && std::abs(p.y() - 6) <= 1) {
+			v.position() = {p.x(), p.y(), p.z() + 4};
+			moved.push_back(v);
+		}
+	}
+	ASSERT_EQ(9u, moved.size());
+
+	for (const Vertex& v : moved)
+		bvh.touch(v);
+	bvh.refitTouched();
+	expectBounding(bvh);
+
+	EXPECT_GT(bvh.bounds().max().z(), 4);
+
+	for (unsigned i = 0; i <= 12; ++i) {
+		Ray ray({0, i * 1.0, 3.5}, {1, 0, 0});
+		expectSameHits(ray.castOnMesh(mesh), ray.castOnBvh(bvh));
+	}
+
+	// Nothing touched, nothing changes
+	Bvh::Node root = bvh.nodes()[0];
+	bvh.refitTouched();
+	EXPECT_TRUE(root.box.max() == bvh.nodes()[0].box.max());
+}
+
+TEST(Bvh, QueriesMatchCast) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh);
+
+	for (unsigned i = 0; i < 40; ++i) {
+		Real angle = i * 0.16;
+		Ray ray({6, 6, 0.1}, {std::cos(angle), std::sin(angle), 0.01 * (i % 5) - 0.02});
+
+		RayHitSet hits = ray.castOnBvh(bvh);
+		EXPECT_EQ(hits.size(), ray.countHits(bvh));
+		EXPECT_EQ(!hits.empty(), ray.castAny(bvh));
+
+		RayHit closest = ray.castClosest(bvh);
+		ASSERT_EQ(!hits.empty(), closest.hasHit());
+		if (closest.hasHit()) {
+			EXPECT_DOUBLE_EQ(hits.begin()->distance(), closest.distance());
+		}
+	}
+}
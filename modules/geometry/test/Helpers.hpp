@@ -0,0 +1,46 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <math/Real>
+#include <geometry/Mesh>
+#include <geometry/Vertex>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+
+/// A n by n grid of squares over the xy plane, with a wavy height. Each square is split in two triangles.
+inline geometry::Mesh terrain(unsigned n) {
+	using math::Real;
+	using geometry::Vertex;
+
+	geometry::Mesh mesh;
+	std::vector<Vertex> vs;
+	for (unsigned i = 0; i <= n; ++i)
+		for (unsigned j = 0; j <= n; ++j)
+			vs.push_back(mesh.addVertex({Real(i), Real(j), std::sin(i * 0.7) * std::cos(j * 0.3)}));
+
+	for (unsigned i = 0; i < n; ++i) {
+		for (unsigned j = 0; j < n; ++j) {
+			Vertex a = vs[i*(n+1) + j];
+			Vertex b = vs[i*(n+1) + j + 1];
+			Vertex c = vs[(i+1)*(n+1) + j];
+			Vertex d = vs[(i+1)*(n+1) + j + 1];
+			mesh.addTriangle(a, b, d);
+			mesh.addTriangle(a, d, c);
+		}
+	}
+
+	return mesh;
+}
+
+/// Checks that two casts hit at the same distances, in the same order.
+inline void expectSameHits(const geometry::RayHitSet& expected, const geometry::RayHitSet& actual) {
+	ASSERT_EQ(expected.size(), actual.size());
+	auto it = actual.begin();
+	for (const geometry::RayHit& hit : expected) {
+		EXPECT_DOUBLE_EQ(hit.distance(), it->distance());
+		++it;
+	}
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <math/Real>
+#include <math/Vector>
+#include <geometry/Mesh>
+#include <geometry/Solid>
+#include <geometry/Triangle>
+#include <geometry/Bvh>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+#include <geometry/HitBuffer>
+#include <geometry/TriangleHit>
+#include <geometry/PackedTriangle>
+
+#include "../../math/test/Tolerance.hpp"
+
+using namespace math;
+using namespace geometry;
+
+TEST(HitBuffer, Finish) {
+	HitBuffer hits;
+	EXPECT_TRUE(hits.empty());
+
+	// Out of order, with a pair at the same distance and a run of near duplicates
+	for (Real d : {3.0, 1.0, 2.0, 1.0, 2.0000004, 2.0000008, 5.0})
+		hits.add(TriangleHit{d, 0, 0, unsigned(d * 10000000) % 7});
+	hits.finish();
+
+	std::vector<Real> expected = {1.0, 2.0000008, 3.0, 5.0};
+	ASSERT_EQ(expected.size(), hits.size());
+	for (unsigned i = 0; i < expected.size(); ++i)
+		EXPECT_EQ(expected[i], hits[i].distance);
+
+	hits.clear();
+	EXPECT_TRUE(hits.empty());
+	hits.finish();
+	EXPECT_EQ(0u, hits.size());
+}
+
+TEST(HitBuffer, MatchesRayHitSet) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+	std::vector<Triangle> triangles(cube.triangles().begin(), cube.triangles().end());
+
+	// The same buffer is reused for every cast
+	HitBuffer hits;
+	for (unsigned i = 0; i < 40; ++i) {
+		Ray ray({-2, 0.05 * i - 1, 0.03 * i - 0.6}, {1, 0.01 * i, i % 3 == 0 ? 0 : 0.2});
+
+		RayHitSet set = ray.castOnMesh(cube);
+		ray.castOnMesh(cube, hits);
+		ASSERT_EQ(set.size(), hits.size());
+
+		auto it = set.begin();
+		for (const TriangleHit& hit : hits) {
+			EXPECT_EQ(it->distance(), hit.distance);
+
+			// The barycentrics give back the hit point, on the triangle with that id
+			PackedTriangle t(triangles[hit.triangle]);
+			Vector3 point = (1 - hit.u - hit.v) * t.vertices[0] + hit.u * t.vertices[1] + hit.v * t.vertices[2];
+			EXPECT_NEAR(0, (point - it->point()).length(), tolerance);
+			++it;
+		}
+
+		ray.castOnBvh(bvh, hits);
+		ASSERT_EQ(set.size(), hits.size());
+		it = set.begin();
+		for (const TriangleHit& hit : hits) {
+			EXPECT_EQ(it->distance(), hit.distance);
+			EXPECT_LT(hit.triangle, bvh.triangles().size());
+			++it;
+		}
+	}
+}
+
+TEST(RayHitSet, InsertAndRemoveDuplicates) {
+	Mesh m;
+	m.addTriangle(m.addVertex({-1, -1, 0}), m.addVertex({1, -1, 0}), m.addVertex({0, 1, 0}));
+	m.addTriangle(m.addVertex({-1, -1, 0.0000005}), m.addVertex({1, -1, 0.0000005}), m.addVertex({0, 1, 0.0000005}));
+	m.addTriangle(m.addVertex({-1, -1, -1}), m.addVertex({1, -1, -1}), m.addVertex({0, 1, -1}));
+
+	Ray ray({0, 0, 1}, {0, 0, -1});
+	RayHitSet set;
+	for (const RayHit& hit : ray.castOnMesh(m))
+		EXPECT_TRUE(set.insert(hit));
+	EXPECT_FALSE(set.insert(*ray.castOnMesh(m).begin()));
+	EXPECT_EQ(2u, set.size());
+
+	// Sorted by distance
+	EXPECT_LT(set.begin()->distance(), std::next(set.begin())->distance());
+
+	Ray other({0, 0, 2}, {0, 0, -1});
+	EXPECT_THROW(set.insert(*other.castOnMesh(m).begin()), std::runtime_error);
+}
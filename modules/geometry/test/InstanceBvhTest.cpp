@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <math/Real>
+#include <math/cte>
+#include <geometry/Solid>
+#include <geometry/Transform>
+#include <geometry/Bvh>
+#include <geometry/InstanceBvh>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+
+#include "../../math/test/Tolerance.hpp"
+
+using namespace math;
+using namespace geometry;
+
+static void expectNearHits(const RayHitSet& expected, const RayHitSet& actual) {
+	ASSERT_EQ(expected.size(), actual.size());
+	auto it = actual.begin();
+	for (const RayHit& hit : expected) {
+		EXPECT_NEAR(hit.distance(), it->distance(), tolerance);
+		++it;
+	}
+}
+
+static Transform placement(unsigned i) {
+	Transform transform;
+	transform.translate({3.0 * (i % 5), 3.0 * (i / 5), 0.5 * i});
+	transform.rotateZ(cte::tau * i / 17);
+	transform.scale({1, 1 + 0.1 * i, 1});
+	return transform;
+}
+
+struct InstanceScene : public ::testing::Test {
+	Solid cube = Solid::cube();
+	Bvh bvh{cube};
+	InstanceBvh instances;
+
+	std::vector<Ray> rays = {
+		Ray({-5, 0.1, 0.2}, {1, 0, 0}),
+		Ray({-5, 3.1, 2.4}, {1, 0, 0.01}),
+		Ray({6.2, -5, 1.5}, {0, 1, 0.1}),
+		Ray({0.05, 0.1, 20}, {0, 0, -1}),
+		Ray({-1, -1, -1}, {1, 1, 0.5}),
+		Ray({-5, 50, 0}, {1, 0, 0})
+	};
+};
+
+TEST_F(InstanceScene, MatchesBakedCopies) {
+	std::vector<Solid> baked;
+	for (unsigned i = 0; i < 15; ++i) {
+		instances.add(bvh, placement(i));
+
+		baked.push_back(Solid::cube());
+		baked.back().apply(placement(i));
+	}
+
+	EXPECT_TRUE(instances.needsUpdate());
+	EXPECT_THROW(rays[0].castOnInstances(instances), std::logic_error);
+	instances.update();
+	EXPECT_FALSE(instances.needsUpdate());
+	EXPECT_EQ(15u, instances.size());
+
+	unsigned total = 0;
+	for (const Ray& ray : rays) {
+		// A mesh with all copies is the same as the union of the hits on each copy
+		RayHitSet expected;
+		for (const Solid& copy : baked)
+			for (const RayHit& hit : ray.castOnMesh(copy))
+				expected.insert(hit);
+		expected.removeDuplicates();
+
+		expectNearHits(expected, ray.castOnInstances(instances));
+		total += expected.size();
+	}
+
+	EXPECT_GT(total, 6u);
+}
+
+TEST_F(InstanceScene, Move) {
+	unsigned a = instances.add(bvh, Transform());
+	unsigned b = instances.add(bvh, placement(3));
+	instances.update();
+
+	Ray ray({-5, 0.1, 0.2}, {1, 0, 0});
+	EXPECT_EQ(2u, ray.castOnInstances(instances).size());
+
+	Transform away;
+	away.translate({0, 10, 0});
+	instances.move(a, away);
+	EXPECT_TRUE(instances.needsUpdate());
+	instances.update();
+	EXPECT_EQ(0u, ray.castOnInstances(instances).size());
+
+	Transform back;
+	back.translate({2, 0, 0});
+	instances.move(b, back);
+	instances.update();
+
+	RayHitSet hits = ray.castOnInstances(instances);
+	ASSERT_EQ(2u, hits.size());
+	EXPECT_NEAR(6.5, hits.begin()->distance(), tolerance);
+}
+
+TEST_F(InstanceScene, SingularTransform) {
+	Transform flat;
+	flat.scale({1, 0, 1});
+	EXPECT_THROW(instances.add(bvh, flat), std::logic_error);
+	EXPECT_EQ(0u, instances.size());
+}
+
+TEST_F(InstanceScene, QueryModes) {
+	for (unsigned i = 0; i < 15; ++i)
+		instances.add(bvh, placement(i));
+	instances.update();
+
+	for (const Ray& ray : rays) {
+		RayHitSet hits = ray.castOnInstances(instances);
+		EXPECT_EQ(!hits.empty(), ray.castAny(instances));
+
+		RayHit closest = ray.castClosest(instances);
+		ASSERT_EQ(!hits.empty(), closest.hasHit());
+		if (closest.hasHit()) {
+			EXPECT_NEAR(hits.begin()->distance(), closest.distance(), tolerance);
+		}
+	}
+}
@@ -1,14 +1,22 @@
 #include <gtest/gtest.h>
+#include <cmath>
 #include <sstream>
 
 #include <math/Real>
 #include <math/cte>
+#include <math/Matrix>
+#include <math/Quaternion>
+#include <math/VectorArray>
+#include <math/ThreadPool>
 #include <geometry/Mesh>
 #include <geometry/Solid>
 #include <geometry/Vertex>
 #include <geometry/Edge>
 #include <geometry/Triangle>
 #include <geometry/Transform>
+#include <geometry/Ray>
+
+#include "../../math/test/Tolerance.hpp"
 
 using namespace math;
 using namespace geometry;
@@ -149,7 +157,7 @@ TEST(Mesh, TransformUniformScale) {
 	for (Edge e : cube.edges()) {
 		bool right = false;
 		if (e.length() == 2) right = true;
-		if (e.length() == 2*sqrt(2)) right = true;
+		if (e.length() == 2 * std::sqrt(Real(2))) right = true;
 		
 		EXPECT_TRUE(right) << e.length();
 	}
@@ -168,13 +176,241 @@ TEST(Mesh, TransformRotation) {
 	
 	for (Edge e : cube.edges()) {
 		bool right = false;
-		if (std::abs(e.length() - 1) < 1e-8) right = true;
-		if (std::abs(e.length() - sqrt(2)) < 1e-8) right = true;
+		if (std::abs(e.length() - 1) < tolerance) right = true;
+		if (std::abs(e.length() - sqrt(2)) < tolerance) right = true;
 		
 		EXPECT_TRUE(right) << e.length();
 	}
 }
 
+TEST(Mesh, TransformInterleaved) {
+	// Rotations are held apart from the matrix until a scaling or translation comes, which must not change the result
+	Transform transform;
+	transform.rotateZ(0.3);
+	transform.rotateX(1.1);
+	transform.scale({1, 2, 3});
+	transform.rotateY(-0.4);
+	transform.translate({1, -2, 0.5});
+	transform.rotate(Quaternion::axisAngle({1, 1, 0}, 0.9));
+	
+	Matrix4 expected = Matrix4::eye();
+	auto rotation = [](const Quaternion& q) {
+		Matrix3 r = q.matrix();
+		Matrix4 m = Matrix4::eye();
+		for (unsigned i = 0; i < 3; ++i)
+			for (unsigned j = 0; j < 3; ++j)
+				m(i, j) = r(i, j);
+		return m;
+	};
+	expected *= rotation(Quaternion::rotationZ(0.3));
+	expected *= rotation(Quaternion::rotationX(1.1));
+	expected *= Matrix4(1, 0, 0, 0, 0, 2, 0, 0, 0, 0, 3, 0, 0, 0, 0, 1);
+	expected *= rotation(Quaternion::rotationY(-0.4));
+	expected *= Matrix4(1, 0, 0, 1, 0, 1, 0, -2, 0, 0, 1, 0.5, 0, 0, 0, 1);
+	expected *= rotation(Quaternion::axisAngle({1, 1, 0}, 0.9));
+	
+	Matrix4 actual = transform.matrix();
+	for (unsigned x = 0; x < 16; ++x)
+		EXPECT_NEAR(expected(x), actual(x), tolerance);
+	
+	Vector3 point = {0.5, -1, 2};
+	Vector4 moved = expected * Vector4(point, 1);
+	Vector3 applied = transform.apply(point);
+	Vector3 back = transform.inverse().apply(applied);
+	for (unsigned c = 0; c < 3; ++c) {
+		EXPECT_NEAR(moved(c), applied(c), tolerance);
+		EXPECT_NEAR(point(c), back(c), tolerance);
+	}
+}
+
+TEST(Mesh, TransformCompose) {
+	Transform a;
+	a.translate({1, 2, 3});
+	a.rotateZ(0.4);
+	a.scale({2, 1, 0.5});
+	a.rotateX(-0.7);
+	
+	Transform b;
+	b.scale(3);
+	b.rotate(Quaternion::axisAngle({1, -1, 1}, 1.3));
+	b.translate({-0.5, 0, 2});
+	
+	Vector3 point = {0.2, -3, 1};
+	Vector3 expected = a.apply(b.apply(point));
+	Vector3 composed = (a * b).apply(point);
+	
+	Transform appended = a;
+	appended *= b;
+	Vector3 vector = appended.applyVector(point);
+	Vector3 expectedVector = a.applyVector(b.applyVector(point));
+	for (unsigned c = 0; c < 3; ++c) {
+		EXPECT_NEAR(expected(c), composed(c), tolerance);
+		EXPECT_NEAR(expectedVector(c), vector(c), tolerance);
+	}
+}
+
+TEST(Mesh, TransformInverse) {
+	Transform transform;
+	transform.translate({1, 2, 3});
+	transform.rotateY(0.9);
+	transform.scale({1, 4, 2});
+	
+	Transform inverse = transform.inverse();
+	Transform back = inverse.inverse();
+	Vector3 point = {3, -1, 0.5};
+	Vector3 moved = transform.apply(point);
+	for (unsigned c = 0; c < 3; ++c) {
+		EXPECT_NEAR(point(c), inverse.apply(moved)(c), tolerance);
+		EXPECT_NEAR(moved(c), back.apply(point)(c), tolerance);
+	}
+	
+	// The cached inverse follows later changes
+	transform.translate({0, 0, 1});
+	moved = transform.apply(point);
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(point(c), transform.inverse().apply(moved)(c), tolerance);
+	
+	transform.scale({1, 0, 1});
+	Transform untouched = inverse;
+	EXPECT_FALSE(transform.tryInverse(untouched));
+	EXPECT_THROW(transform.inverse(), std::logic_error);
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(point(c), untouched.apply(inverse.inverse().apply(point))(c), tolerance);
+}
+
+TEST(Mesh, TransformDecompose) {
+	Vector3 translation = {1, -2, 3};
+	Quaternion rotation = Quaternion::axisAngle({1, 2, -1}, 2.5);
+	Vector3 scale = {2, 0.5, 3};
+	
+	// The same transformation, built from its parts and from operations
+	Transform parts(translation, rotation, scale);
+	Transform operations;
+	operations.translate(translation);
+	operations.rotate(rotation);
+	operations.scale(scale);
+	
+	for (const Transform& transform : {parts, operations}) {
+		Vector3 t, s;
+		Quaternion r;
+		transform.decompose(t, r, s);
+		for (unsigned c = 0; c < 3; ++c) {
+			EXPECT_NEAR(translation(c), t(c), tolerance);
+			EXPECT_NEAR(scale(c), s(c), tolerance);
+		}
+		EXPECT_NEAR(1, std::abs(rotation.dot(r)), tolerance);
+	}
+	
+	// A mirror comes out as a negative scale
+	Transform mirror;
+	mirror.rotateZ(0.3);
+	mirror.scale({1, -1, 1});
+	Vector3 t, s;
+	Quaternion r;
+	mirror.decompose(t, r, s);
+	Transform rebuilt(t, r, s);
+	Vector3 point = {1, 2, 3};
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(mirror.apply(point)(c), rebuilt.apply(point)(c), tolerance);
+	
+	Transform flat;
+	flat.scale(0);
+	EXPECT_THROW(flat.decompose(t, r, s), std::logic_error);
+}
+
+TEST(Mesh, TransformBatched) {
+	Transform transform;
+	transform.translate({1, -2, 0.5});
+	transform.rotateY(0.6);
+	transform.scale({2, 1, 3});
+	transform.rotateZ(-1.2);
+	
+	std::vector<Vector3> vectors;
+	for (int i = 0; i < 10; ++i)
+		vectors.push_back({Real(i), std::sin(Real(i)), Real(1 - i)});
+	VectorArray<3> points(vectors), directions, normals;
+	transform.applyVector(points, directions);
+	transform.applyNormal(points, normals);
+	
+	ThreadPool pool(2);
+	transform.apply(points, points, &pool);
+	
+	for (std::size_t i = 0; i < vectors.size(); ++i) {
+		Vector3 point = transform.apply(vectors[i]);
+		Vector3 direction = transform.applyVector(vectors[i]);
+		for (unsigned c = 0; c < 3; ++c) {
+			EXPECT_NEAR(point(c), points.get(i)(c), tolerance);
+			EXPECT_NEAR(direction(c), directions.get(i)(c), tolerance);
+		}
+		
+		// Normals stay perpendicular to transformed tangents
+		Vector3 tangent = vectors[i].cross({1, 0, 0});
+		EXPECT_NEAR(0, normals.get(i).dot(transform.applyVector(tangent)), tolerance);
+	}
+}
+
+TEST(Mesh, TransformRotationDrift) {
+	// The rounding of many composed rotations must not scale points, nor split the scalar and batched paths
+	Transform transform;
+	for (int i = 0; i < 100000; ++i)
+		transform.rotate(Quaternion::axisAngle({1, 2, 3}, Real(0.1)));
+	
+	VectorArray<3> vectors(std::vector<Vector3>{{1, 0, 0}, {0, 0.6, 0.8}}), out;
+	transform.applyVector(vectors, out);
+	for (std::size_t i = 0; i < vectors.size(); ++i) {
+		Vector3 vector = transform.applyVector(vectors.get(i));
+		EXPECT_NEAR(1, vector.length(), tolerance);
+		for (unsigned c = 0; c < 3; ++c)
+			EXPECT_NEAR(out.get(i)(c), vector(c), tolerance);
+	}
+}
+
+TEST(Mesh, DeferredTransform) {
+	Transform scale, rotation, translation;
+	scale.scale({2, 1, 0.5});
+	rotation.rotateZ(0.7);
+	translation.translate({3, -1, 2});
+	
+	Solid eager = Solid::cube();
+	for (const Transform& t : {scale, rotation, translation}) eager.apply(t);
+	
+	Solid deferred = Solid::cube();
+	deferred.setDeferred(true);
+	Vertex kept = *deferred.vertices().begin();
+	Vector3 before = kept.position();
+	for (const Transform& t : {scale, rotation, translation}) deferred.apply(t);
+	
+	// Nothing moved yet, the inverse is ready for rays, and rays are cast without moving anything
+	EXPECT_TRUE(deferred.hasPending());
+	EXPECT_TRUE(deferred.hasPendingInverse());
+	EXPECT_EQ(before, kept.position());
+	
+	Ray ray({-5, -1.2, 1.9}, {1, 0.1, 0.02});
+	RayHitSet expected = ray.castOnMesh(eager);
+	RayHitSet hits = ray.castOnMesh(deferred);
+	EXPECT_TRUE(deferred.hasPending());
+	ASSERT_EQ(expected.size(), hits.size());
+	EXPECT_EQ(2u, hits.size());
+	for (auto e = expected.begin(), h = hits.begin(); e != expected.end(); ++e, ++h)
+		EXPECT_NEAR(e->distance(), h->distance(), tolerance);
+	
+	// Reading the vertices moves them all at once
+	Vector3 center = deferred.center();
+	EXPECT_FALSE(deferred.hasPending());
+	EXPECT_FALSE(deferred.hasPendingInverse());
+	EXPECT_FALSE(before == kept.position());
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(eager.center()(c), center(c), tolerance);
+	EXPECT_NEAR(eager.volume(), deferred.volume(), tolerance);
+	
+	// Leaving the deferred mode applies what is pending
+	deferred.apply(translation);
+	EXPECT_TRUE(deferred.hasPending());
+	deferred.setDeferred(false);
+	EXPECT_FALSE(deferred.hasPending());
+	EXPECT_NEAR(eager.center().x() + 3, deferred.center().x(), tolerance);
+}
+
 TEST(Mesh, TransformTranslate) {
 	Solid cube = Solid::cube();
 	Vector3 center = cube.center();
@@ -194,8 +430,8 @@ TEST(Mesh, TransformTranslate) {
 	
 	for (Edge e : cube.edges()) {
 		bool right = false;
-		if (std::abs(e.length() - 1) < 1e-8) right = true;
-		if (std::abs(e.length() - sqrt(2)) < 1e-8) right = true;
+		if (std::abs(e.length() - 1) < tolerance) right = true;
+		if (std::abs(e.length() - sqrt(2)) < tolerance) right = true;
 		
 		EXPECT_TRUE(right) << e.length();
 	}
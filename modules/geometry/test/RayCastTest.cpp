@@ -7,6 +7,11 @@
 #include <geometry/Triangle>
 #include <geometry/Ray>
 #include <geometry/RayHit>
+#include <geometry/Bvh>
+#include <geometry/PackedTriangle>
+#include <geometry/TriangleHit>
+
+#include "Helpers.hpp"
 
 using math::Real;
 using geometry::Mesh;
@@ -15,8 +20,13 @@ using geometry::Edge;
 using geometry::Triangle;
 using geometry::Ray;
 using geometry::RayHit;
+using geometry::RayHitSet;
+using geometry::Bvh;
+using geometry::PackedTriangle;
+using geometry::TriangleHit;
 #include <iostream>
 using namespace std;
+
 TEST(RayCast, ComplexMesh) {
 	Mesh mesh;
 
@@ -97,6 +107,10 @@ TEST(RayCast, ComplexMesh) {
 	EXPECT_TRUE(ray6.castOnTriangle(t146).hasHit());
 	EXPECT_TRUE(ray6.castOnTriangle(t347).hasHit());
 	EXPECT_EQ(2u, ray6.castOnMesh(mesh).size());
+
+	Bvh bvh(mesh);
+	for (const Ray& ray : {ray1, ray2, ray3, ray4, ray5, ray6})
+		expectSameHits(ray.castOnMesh(mesh), ray.castOnBvh(bvh));
 }
 
 TEST(RayCast, Triangles) {
@@ -128,4 +142,80 @@ TEST(RayCast, Triangles) {
 	EXPECT_DOUBLE_EQ(0.5, hit2.point().x());
 	EXPECT_DOUBLE_EQ(0.5, hit2.point().y());
 	EXPECT_DOUBLE_EQ(0, hit2.point().z());
+
+	expectSameHits(hits, ray.castOnBvh(Bvh(m)));
+}
+
+TEST(RayCast, QueryModes) {
+	Mesh m;
+
+	// Three parallel squares at z = 0, 1 and 2
+	for (int z = 0; z < 3; ++z) {
+		Vertex a = m.addVertex({0, 0, Real(z)});
+		Vertex b = m.addVertex({1, 0, Real(z)});
+		Vertex c = m.addVertex({1, 1, Real(z)});
+		Vertex d = m.addVertex({0, 1, Real(z)});
+		m.addTriangle(a, b, c);
+		m.addTriangle(a, c, d);
+	}
+
+	Bvh bvh(m);
+
+	// Crosses the diagonal of each square, where two triangles meet
+	Ray ray{{0.5, 0.5, 5}, {0, 0, -1}};
+	EXPECT_EQ(3u, ray.castOnBvh(bvh).size());
+	EXPECT_EQ(3u, ray.countHits(bvh));
+	EXPECT_TRUE(ray.castAny(bvh));
+
+	RayHit closest = ray.castClosest(bvh);
+	ASSERT_TRUE(closest.hasHit());
+	EXPECT_DOUBLE_EQ(3, closest.distance());
+
+	Ray segment{{0.25, 0.5, 5}, {0, 0, -1}, 3.5, 4.5};
+	EXPECT_EQ(1u, segment.castOnMesh(m).size());
+	EXPECT_EQ(1u, segment.castOnBvh(bvh).size());
+	EXPECT_EQ(1u, segment.countHits(bvh));
+	EXPECT_DOUBLE_EQ(4, segment.castClosest(bvh).distance());
+
+	Ray shortSegment{{0.25, 0.5, 5}, {0, 0, -1}, 0, 2.5};
+	EXPECT_EQ(0u, shortSegment.castOnMesh(m).size());
+	EXPECT_EQ(0u, shortSegment.countHits(bvh));
+	EXPECT_FALSE(shortSegment.castAny(bvh));
+	EXPECT_FALSE(shortSegment.castClosest(bvh).hasHit());
+
+	Ray miss{{2, 2, 5}, {0, 0, -1}};
+	EXPECT_EQ(0u, miss.countHits(bvh));
+	EXPECT_FALSE(miss.castAny(bvh));
+	EXPECT_FALSE(miss.castClosest(bvh).hasHit());
+}
+
+TEST(RayCast, TriangleKernel) {
+	PackedTriangle triangle;
+	triangle.vertices = {{{0, 0, 0}, {2, 0, 0}, {0, 2, 0}}};
+
+	TriangleHit hit;
+	Ray ray{{0.5, 0.25, 3}, {0, 0, -2}};
+	ASSERT_TRUE(ray.castOnTriangle(triangle, 7, hit));
+	EXPECT_DOUBLE_EQ(1.5, hit.distance);
+	EXPECT_DOUBLE_EQ(0.25, hit.u);
+	EXPECT_DOUBLE_EQ(0.125, hit.v);
+	EXPECT_EQ(7u, hit.triangle);
+
+	// From behind, the triangle is hit all the same
+	Ray back{{0.5, 0.25, -3}, {0, 0, 1}};
+	ASSERT_TRUE(back.castOnTriangle(triangle, 0, hit));
+	EXPECT_DOUBLE_EQ(3, hit.distance);
+
+	// Edges and vertices belong to the triangle
+	EXPECT_TRUE(Ray({1, 1, 1}, {0, 0, -1}).castOnTriangle(triangle, 0, hit));
+	EXPECT_TRUE(Ray({0, 2, 1}, {0, 0, -1}).castOnTriangle(triangle, 0, hit));
+	EXPECT_FALSE(Ray({1.01, 1, 1}, {0, 0, -1}).castOnTriangle(triangle, 0, hit));
+
+	// Parallel rays and degenerate triangles are plain misses
+	EXPECT_FALSE(Ray({-1, 0.5, 0}, {1, 0, 0}).castOnTriangle(triangle, 0, hit));
+
+	PackedTriangle degenerate;
+	degenerate.vertices = {{{0, 0, 0}, {1, 1, 0}, {2, 2, 0}}};
+	EXPECT_FALSE(ray.castOnTriangle(degenerate, 0, hit));
+	EXPECT_FALSE(Ray({1, 1, 1}, {0, 0, -1}).castOnTriangle(degenerate, 0, hit));
 }
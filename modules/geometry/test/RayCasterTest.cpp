@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+#include <math/Real>
+#include <geometry/Solid>
+#include <geometry/Bvh>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayCaster>
+#include <geometry/TriangleHit>
+
+using namespace math;
+using namespace geometry;
+
+/// Rays from all around a unit sphere towards points near the origin, so some miss and some graze.
+static std::vector<Ray> raysAround(unsigned count) {
+	std::vector<Ray> rays;
+	for (unsigned i = 0; i < count; ++i) {
+		Real a = i * 0.618034 * 6.283185;
+		Real b = std::acos(1 - 2 * (i + 0.5) / count);
+		Vector3 origin{3 * std::sin(b) * std::cos(a), 3 * std::sin(b) * std::sin(a), 3 * std::cos(b)};
+		Vector3 target{0.3 * std::sin(i * 1.1), 0.3 * std::cos(i * 0.7), 0.6 * std::sin(i * 0.3)};
+		rays.push_back(Ray(origin, target - origin, 0, i % 7 == 0 ? 0.5 : 10));
+	}
+	return rays;
+}
+
+TEST(RayCaster, MatchesRayQueries) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+	std::vector<Ray> rays = raysAround(3000);
+	RayCaster caster(4);
+	EXPECT_EQ(4u, caster.threads());
+
+	std::vector<RayCaster::Result> closest(rays.size()), any(rays.size()), count(rays.size());
+	caster.cast(bvh, rays.data(), rays.size(), RayCaster::Query::Closest, closest.data());
+	caster.cast(bvh, rays.data(), rays.size(), RayCaster::Query::Any, any.data());
+	caster.cast(bvh, rays.data(), rays.size(), RayCaster::Query::Count, count.data());
+
+	unsigned hits = 0;
+	for (unsigned i = 0; i < rays.size(); ++i) {
+		TriangleHit hit;
+		bool expected = rays[i].castClosest(bvh, hit);
+		ASSERT_EQ(expected, closest[i].hit);
+		if (expected) {
+			EXPECT_EQ(hit.distance, closest[i].distance);
+			EXPECT_EQ(hit.triangle, closest[i].triangle);
+			EXPECT_EQ(rays[i].castClosest(bvh).distance(), closest[i].distance);
+			++hits;
+		}
+
+		EXPECT_EQ(rays[i].castAny(bvh), any[i].hit);
+		EXPECT_EQ(rays[i].countHits(bvh), count[i].count);
+		EXPECT_EQ(count[i].count > 0, count[i].hit);
+	}
+
+	// Most rays aim at the cube, the short ones don't reach it
+	EXPECT_LT(rays.size() / 2, hits);
+	EXPECT_GT(rays.size(), hits);
+}
+
+TEST(RayCaster, ThreadCountDoesNotChangeResults) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+	std::vector<Ray> rays = raysAround(5000);
+
+	std::vector<RayCaster::Result> single(rays.size()), many(rays.size());
+	RayCaster(1).cast(bvh, rays.data(), rays.size(), RayCaster::Query::Closest, single.data());
+	RayCaster(8).cast(bvh, rays.data(), rays.size(), RayCaster::Query::Closest, many.data());
+
+	for (unsigned i = 0; i < rays.size(); ++i) {
+		EXPECT_EQ(single[i].hit, many[i].hit);
+		EXPECT_EQ(single[i].distance, many[i].distance);
+		EXPECT_EQ(single[i].triangle, many[i].triangle);
+	}
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include <math/Real>
+#include <math/Vector>
+#include <geometry/Mesh>
+#include <geometry/Solid>
+#include <geometry/Vertex>
+#include <geometry/BoundingBox>
+#include <geometry/Bvh>
+#include <geometry/PackedTriangle>
+#include <geometry/TriangleHit>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+#include <geometry/RayPacket>
+
+#include "Helpers.hpp"
+
+using namespace math;
+using namespace geometry;
+
+/// Rays of every kind: bundles, all dominant axes, zero components, limited ranges and a zero direction.
+static std::vector<Ray> mixedRays() {
+	std::vector<Ray> rays;
+	for (unsigned i = 0; i < 12; ++i) {
+		Real angle = i * 0.37;
+		rays.push_back(Ray({6, 6, 3}, {0.01 * std::cos(angle), 0.01 * std::sin(angle), -1}));
+	}
+	rays.push_back(Ray({6, 6, 0.1}, {1, 0.3, -0.01}));
+	rays.push_back(Ray({6, 6, 0.1}, {-0.2, -1, 0.02}));
+	rays.push_back(Ray({2, 3, -4}, {0, 0, 1}));
+	rays.push_back(Ray({2, 3, 4}, {0, 0, -1}, 1, 3));
+	rays.push_back(Ray({-1, 5, 0.2}, {1, 0, 0}));
+	rays.push_back(Ray({3, -1, 0}, {0, 1, 0}, 0, 4));
+	rays.push_back(Ray({5, 5, 5}, {0, 0, 0}));
+	rays.push_back(Ray({4, 4, 2}, {0, 0, -1}, 5, 1));
+	rays.push_back(Ray({20, 20, 20}, {1, 1, 1}));
+	rays.push_back(Ray({0, 0, 3}, {1, 1, -0.5}));
+	rays.push_back(Ray({6, 6, 0}, {1, -1, 0.5}, -2));
+	return rays;
+}
+
+template <unsigned W>
+static void expectSameAsRays(const Bvh& bvh, const std::vector<Ray>& rays) {
+	for (unsigned first = 0; first < rays.size(); first += W) {
+		unsigned count = std::min<unsigned>(W, rays.size() - first);
+		RayPacket<W> packet(&rays[first], count);
+		ASSERT_EQ(count, packet.size());
+
+		std::array<RayHitSet, W> sets = packet.castOnBvh(bvh);
+		for (unsigned lane = 0; lane < W; ++lane) {
+			if (lane >= count) {
+				EXPECT_TRUE(sets[lane].empty());
+				continue;
+			}
+
+			RayHitSet expected = rays[first + lane].castOnBvh(bvh);
+			ASSERT_EQ(expected.size(), sets[lane].size());
+			auto it = sets[lane].begin();
+			for (const RayHit& hit : expected) {
+				EXPECT_EQ(hit.distance(), it->distance());
+				++it;
+			}
+		}
+	}
+}
+
+TEST(RayPacket, Lanes) {
+	std::vector<Ray> rays = mixedRays();
+
+	RayPacket<4> packet(rays.data(), 3);
+	EXPECT_EQ(3u, packet.size());
+	EXPECT_EQ(7u, packet.active());
+	EXPECT_TRUE(packet.ray(2) == rays[2]);
+
+	RayPacket<8> empty(rays.data(), 0);
+	EXPECT_EQ(0u, empty.active());
+
+	EXPECT_THROW(RayPacket<4>(rays.data(), 5), std::logic_error);
+}
+
+TEST(RayPacket, BoxMatchesRays) {
+	std::vector<Ray> rays = mixedRays();
+	std::vector<BoundingBox> boxes;
+	boxes.push_back(BoundingBox());
+	for (unsigned i = 0; i < 6; ++i) {
+		BoundingBox box;
+		box.extend(Vector3{i * 1.5, 6.0 - i, -1.0 + i * 0.3});
+		box.extend(Vector3{i * 1.5 + 1, 7.0 - i, i * 0.3});
+		boxes.push_back(box);
+	}
+
+	// A flat box, on the plane some rays run along
+	BoundingBox flat;
+	flat.extend(Vector3{-2, -2, 0.2});
+	flat.extend(Vector3{10, 10, 0.2});
+	boxes.push_back(flat);
+
+	for (unsigned first = 0; first + 8 <= rays.size(); first += 8) {
+		RayPacket<8> packet(&rays[first], 8);
+		for (const BoundingBox& box : boxes) {
+			unsigned expected = 0;
+			for (unsigned lane = 0; lane < 8; ++lane) {
+				Real near, far;
+				if (rays[first + lane].castOnBox(box, near, far)) expected |= 1u << lane;
+			}
+			EXPECT_EQ(expected, packet.castOnBox(box, packet.active()));
+			EXPECT_EQ(expected & 0x5u, packet.castOnBox(box, 0x5));
+		}
+	}
+}
+
+TEST(RayPacket, TriangleMatchesRays) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh);
+	std::vector<Ray> rays = mixedRays();
+
+	for (unsigned first = 0; first + 4 <= rays.size(); first += 4) {
+		RayPacket<4> packet(&rays[first], 4);
+		for (unsigned i = 0; i < bvh.packedTriangles().size(); ++i) {
+			std::array<TriangleHit, 4> hits;
+			unsigned mask = packet.castOnTriangle(bvh.packedTriangles()[i], i, packet.active(), hits);
+
+			for (unsigned lane = 0; lane < 4; ++lane) {
+				TriangleHit expected;
+				bool hit = rays[first + lane].castOnTriangle(bvh.packedTriangles()[i], i, expected);
+				ASSERT_EQ(hit, (mask & (1u << lane)) != 0);
+				if (!hit) continue;
+
+				EXPECT_EQ(expected.distance, hits[lane].distance);
+				EXPECT_EQ(expected.u, hits[lane].u);
+				EXPECT_EQ(expected.v, hits[lane].v);
+				EXPECT_EQ(i, hits[lane].triangle);
+			}
+		}
+	}
+}
+
+TEST(RayPacket, CastMatchesRays) {
+	Mesh mesh = terrain(12);
+	Bvh bvh(mesh);
+
+	// Vertical bundles, many of them crossing exactly through vertices and edges
+	std::vector<Ray> vertical;
+	for (unsigned i = 0; i <= 24; ++i)
+		for (unsigned j = 0; j < 24; ++j)
+			vertical.push_back(Ray({i * 0.5, j * 0.5, 5}, {0, 0, -1}));
+
+	expectSameAsRays<4>(bvh, vertical);
+	expectSameAsRays<8>(bvh, vertical);
+	expectSameAsRays<4>(bvh, mixedRays());
+	expectSameAsRays<8>(bvh, mixedRays());
+}
+
+TEST(RayPacket, CastOnSolid) {
+	Solid cube = Solid::cube();
+	Bvh bvh(cube);
+
+	std::vector<Ray> rays;
+	for (unsigned i = 0; i < 16; ++i)
+		rays.push_back(Ray({-2, 0.1 * i - 0.8, 0.05 * i}, {1, 0.01 * i, -0.02}));
+
+	expectSameAsRays<4>(bvh, rays);
+	expectSameAsRays<8>(bvh, rays);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include <math/Real>
+#include <math/Vector>
+#include <geometry/SceneNode>
+#include <geometry/Transform>
+
+#include "../../math/test/Tolerance.hpp"
+
+using namespace math;
+using namespace geometry;
+
+static Transform moved(const Vector3& translation, Real angle) {
+	Transform transform;
+	transform.translate(translation);
+	transform.rotateZ(angle);
+	return transform;
+}
+
+static void expectNear(const Vector3& expected, const Vector3& actual) {
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(expected(c), actual(c), tolerance);
+}
+
+TEST(SceneNode, WorldIsChained) {
+	SceneNode body(moved({10, 0, 0}, 0.5));
+	SceneNode& turret = body.addChild(moved({0, 1, 0}, 0.3));
+	SceneNode& barrel = turret.addChild(moved({0, 0, 2}, -0.2));
+
+	EXPECT_EQ(&body, turret.parent());
+	EXPECT_EQ(&turret, barrel.parent());
+	EXPECT_EQ(nullptr, body.parent());
+	EXPECT_EQ(1u, body.size());
+	EXPECT_EQ(&turret, &body.child(0));
+	EXPECT_THROW(body.child(1), std::logic_error);
+
+	Vector3 point = {1, 2, 3};
+	Vector3 expected = body.local().apply(turret.local().apply(barrel.local().apply(point)));
+	expectNear(expected, barrel.world().apply(point));
+	expectNear(point, barrel.world().inverse().apply(expected));
+}
+
+TEST(SceneNode, OnlyChangedSubtreesAreDirty) {
+	SceneNode body;
+	SceneNode& left = body.addChild(moved({-1, 0, 0}, 0));
+	SceneNode& right = body.addChild(moved({1, 0, 0}, 0));
+	SceneNode& rotor = left.addChild(moved({0, 0, 1}, 0));
+	body.update();
+
+	EXPECT_FALSE(body.dirty());
+	EXPECT_FALSE(rotor.dirty());
+
+	// Spinning a part only dirties it and what hangs from it
+	left.setLocal(moved({-1, 0, 0}, 1.2));
+	EXPECT_FALSE(body.dirty());
+	EXPECT_FALSE(right.dirty());
+	EXPECT_TRUE(left.dirty());
+	EXPECT_TRUE(rotor.dirty());
+
+	// Reading a world transform cleans it and its ancestors
+	Vector3 tip = rotor.world().apply({0, 0, 0});
+	EXPECT_FALSE(left.dirty());
+	EXPECT_FALSE(rotor.dirty());
+	expectNear(left.world().apply({0, 0, 1}), tip);
+
+	// Moving the root dirties everything, and update() cleans everything
+	body.setLocal(moved({0, 5, 0}, 0));
+	EXPECT_TRUE(right.dirty());
+	EXPECT_TRUE(rotor.dirty());
+	body.update();
+	EXPECT_FALSE(right.dirty());
+	EXPECT_FALSE(rotor.dirty());
+	expectNear({1, 5, 0}, right.world().apply({0, 0, 0}));
+}
@@ -9,6 +9,8 @@
 #include <geometry/Triangle>
 #include <geometry/Transform>
 
+#include "../../math/test/Tolerance.hpp"
+
 using namespace math;
 using namespace geometry;
 
@@ -70,9 +72,9 @@ TEST(Solid, ShapeVolume) {
 	cube.apply(transform);
 	
 	Vector3 center = cube.center();
-	EXPECT_TRUE(std::abs(center.x()) < 1e-8) << center.x();
-	EXPECT_TRUE(std::abs(center.y()) < 1e-8) << center.y();
-	EXPECT_TRUE(std::abs(center.z()) < 1e-8) << center.z();
+	EXPECT_TRUE(std::abs(center.x()) < tolerance) << center.x();
+	EXPECT_TRUE(std::abs(center.y()) < tolerance) << center.y();
+	EXPECT_TRUE(std::abs(center.z()) < tolerance) << center.z();
 	
 	for (Triangle t : cube.triangles()) {
 		Vector3 pointAway = t.position() + t.normal();
@@ -80,7 +82,7 @@ TEST(Solid, ShapeVolume) {
 		EXPECT_GT(dist, 1);
 	}
 	
-	EXPECT_DOUBLE_EQ(6, cube.volume());
+	EXPECT_NEAR(6, cube.volume(), 6 * tolerance);
 }
 
 TEST(Solid, ShapeOrientation) {
@@ -95,9 +97,9 @@ TEST(Solid, ShapeOrientation) {
 	cube.orient();
 	
 	Vector3 center = cube.center();
-	EXPECT_TRUE(std::abs(center.x()) < 1e-8) << center.x();
-	EXPECT_TRUE(std::abs(center.y()) < 1e-8) << center.y();
-	EXPECT_TRUE(std::abs(center.z()) < 1e-8) << center.z();
+	EXPECT_TRUE(std::abs(center.x()) < tolerance) << center.x();
+	EXPECT_TRUE(std::abs(center.y()) < tolerance) << center.y();
+	EXPECT_TRUE(std::abs(center.z()) < tolerance) << center.z();
 	
 	for (Triangle t : cube.triangles()) {
 		Vector3 pointAway = t.position() + t.normal();
@@ -105,5 +107,5 @@ TEST(Solid, ShapeOrientation) {
 		EXPECT_GT(dist, 1);
 	}
 	
-	EXPECT_DOUBLE_EQ(6, cube.volume());
+	EXPECT_NEAR(6, cube.volume(), 6 * tolerance);
 }
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+#include <math/Real>
+#include <math/Vector>
+#include <geometry/StaticMesh>
+#include <geometry/Solid>
+#include <geometry/Vertex>
+#include <geometry/Triangle>
+#include <geometry/Ray>
+#include <geometry/RayHit>
+#include <geometry/RayHitSet>
+
+#include "../../math/test/Tolerance.hpp"
+
+using namespace math;
+using namespace geometry;
+
+namespace {
+
+// Built at compile time
+constexpr StaticMesh<8, 12> cube = staticCube();
+constexpr StaticMesh<4, 4> tetrahedron = staticCone<3>();
+constexpr StaticMesh<7, 10> hexagonal = staticCone<6>();
+
+}
+
+TEST(StaticMesh, Constants) {
+	static_assert(cube.volume() == 1, "The cube is a unit cube");
+	static_assert(cube.vertex(6).x() == 0.5, "The cube is centered");
+	static_assert(cube.index(11, 2) == 7, "Triangles are set");
+
+	for (unsigned c = 0; c < 3; ++c) {
+		EXPECT_NEAR(0, tetrahedron.center()(c), tolerance);
+		EXPECT_NEAR(0, hexagonal.center()(c), tolerance);
+	}
+
+	// A pyramid is a third of its base times its height
+	EXPECT_NEAR(std::sqrt(3) / 4 / 3, tetrahedron.volume(), tolerance);
+	EXPECT_NEAR(3 * std::sqrt(3) / 2 / 3, hexagonal.volume(), tolerance);
+	EXPECT_NEAR(1, (hexagonal.vertex(1) - hexagonal.vertex(0)).length(), tolerance);
+}
+
+TEST(StaticMesh, ToSolid) {
+	Solid solid = hexagonal.toSolid();
+	EXPECT_EQ(7u, solid.vertices().size());
+	EXPECT_EQ(10u, solid.triangles().size());
+	EXPECT_EQ(15u, solid.edges().size());
+
+	// The orientation is kept, so the volume needs no orient(), and the normals agree with the vertex order
+	EXPECT_NEAR(hexagonal.volume(), solid.volume(), tolerance);
+	for (const Triangle& t : solid.triangles()) {
+		const Vector3& a = t.vertices()[0].position();
+		Vector3 area = (t.vertices()[1].position() - a).cross(t.vertices()[2].position() - a);
+		EXPECT_GT(area.dot(t.vectorArea()), 0);
+	}
+
+	Solid box = Solid::cube();
+	EXPECT_EQ(18u, box.edges().size());
+	EXPECT_DOUBLE_EQ(1, box.volume());
+}
+
+TEST(StaticMesh, SolidCone) {
+	// Solid::cone() is the constant cone, with the apex above the center of the base
+	Solid tetra = Solid::cone(3);
+	EXPECT_EQ(4u, tetra.vertices().size());
+	EXPECT_NEAR(tetrahedron.volume(), tetra.volume(), tolerance);
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(0, tetra.center()(c), tolerance);
+	for (const Vertex& v : tetra.vertices())
+		if (v.position().z() > 0) {
+			EXPECT_NEAR(0, v.position().x(), tolerance);
+			EXPECT_NEAR(0, v.position().y(), tolerance);
+		}
+
+	EXPECT_NEAR(hexagonal.volume(), Solid::cone(6).volume(), tolerance);
+	EXPECT_EQ(9u, Solid::cone(8).vertices().size());
+	EXPECT_THROW(Solid::cone(2), std::logic_error);
+	EXPECT_THROW(Solid::cone(9), std::logic_error);
+}
+
+TEST(StaticMesh, Cast) {
+	Solid solid = cube.toSolid();
+	Ray rays[] = {
+		{{-2, 0.1, 0.2}, {1, 0, 0}},
+		{{-1, -1, -1}, {1, 1, 1}},
+		{{0.3, -0.2, 5}, {0.05, 0.02, -1}},
+		{{-2, 0, 0}, {-1, 0, 0}}
+	};
+
+	for (const Ray& ray : rays) {
+		RayHitSet expected = ray.castOnMesh(solid);
+		RayHitSet hits = cube.cast(ray);
+		ASSERT_EQ(expected.size(), hits.size());
+		auto it = hits.begin();
+		for (const RayHit& hit : expected) {
+			EXPECT_NEAR(hit.distance(), it->distance(), tolerance);
+			++it;
+		}
+		EXPECT_EQ(!expected.empty(), cube.castAny(ray));
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace math {
+
+/*!
+ * \brief The AlignedAllocator class is a standard allocator whose blocks start at a multiple of Alignment bytes.
+ *
+ * Until C++17, operator new only aligns to alignof(std::max_align_t), which is less than an AVX register.
+ * This allocator asks for Alignment extra bytes and stores where the block really starts right before the
+ * returned address.
+ */
+template <typename T, std::size_t Alignment = 32>
+class AlignedAllocator {
+	static_assert(Alignment >= sizeof(void*) && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+public:
+
+	using value_type = T;
+
+	template <typename U>
+	struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+	AlignedAllocator() = default;
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+	T* allocate(std::size_t n) {
+		char* block = static_cast<char*>(::operator new(n * sizeof(T) + Alignment));
+		std::uintptr_t start = (reinterpret_cast<std::uintptr_t>(block) + Alignment) & ~std::uintptr_t(Alignment - 1);
+		reinterpret_cast<char**>(start)[-1] = block;
+		return reinterpret_cast<T*>(start);
+	}
+
+	void deallocate(T* p, std::size_t) {
+		::operator delete(reinterpret_cast<char**>(p)[-1]);
+	}
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+
+};
+
+}  // math namespace
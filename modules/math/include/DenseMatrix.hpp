@@ -0,0 +1,71 @@
+#pragma once
+
+#include <math/Real>
+#include <math/ThreadPool>
+#include <math/AlignedAllocator>
+#include <cstddef>
+#include <vector>
+
+namespace math {
+
+/*!
+ * \brief The DenseMatrix class is a matrix whose size is only known at run time, stored row by row on the heap.
+ *
+ * Unlike Matrix, it can hold systems the size of a mesh, but each operation allocates its result. Sizes are checked
+ * on every operation, and a mismatch throws std::logic_error.
+ *
+ * Products are computed by blocks of rows of the left matrix and of the right matrix, so each block stays in the cache
+ * while it is used, and the innermost loop runs along rows of both matrices on SIMD registers.
+ */
+class DenseMatrix {
+public:
+
+	/// A matrix of no rows and no columns.
+	DenseMatrix();
+
+	/// A matrix of zeros.
+	DenseMatrix(std::size_t rows, std::size_t cols);
+
+	/// The identity matrix of size n.
+	static DenseMatrix eye(std::size_t n);
+
+	std::size_t rows() const;
+	std::size_t cols() const;
+
+	Real& operator()(std::size_t i, std::size_t j);
+	const Real& operator()(std::size_t i, std::size_t j) const;
+
+	/// The cells, row by row.
+	Real* data();
+	const Real* data() const;
+
+	DenseMatrix transpost() const;
+
+	DenseMatrix& operator+=(const DenseMatrix& other);
+	DenseMatrix& operator-=(const DenseMatrix& other);
+	DenseMatrix& operator*=(Real real);
+
+	DenseMatrix operator+(const DenseMatrix& other) const;
+	DenseMatrix operator-(const DenseMatrix& other) const;
+	DenseMatrix operator*(Real real) const;
+
+	/// Matrix product. Complexity: O(rows * cols * other.cols())
+	DenseMatrix operator*(const DenseMatrix& other) const;
+
+	/// Matrix vector product. Complexity: O(rows * cols)
+	std::vector<Real> operator*(const std::vector<Real>& vec) const;
+
+	/// \brief Computes a * b into result, which is resized, and may be a or b.
+	///
+	/// When a pool is given, the blocks of rows of a are split between its threads.
+	static void multiply(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& result, ThreadPool* pool = nullptr);
+
+private:
+
+	std::size_t _rows;
+	std::size_t _cols;
+	std::vector<Real, AlignedAllocator<Real>> _v;
+
+};
+
+} // namespace math
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Simd>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+namespace math {
+
+/*!
+ * \brief Counterparts of the <cmath> functions that can also run during constant evaluation.
+ *
+ * They let fixed values, such as the rotation of a rotor mount or the vertices of a primitive, be computed into
+ * constexpr constants. At run time they call the <cmath> functions. Compilers that can't tell the two apart always
+ * take the constant path, which gives the same results to within a couple of units in the last place, only slower.
+ */
+namespace cmath {
+
+namespace internal {
+	/// sin(x) for x in [-pi/2, pi/2], from its Taylor series
+	template <typename T>
+	constexpr T sinSeries(T x) {
+		T term = x, sum = x;
+		for (int n = 1; term != 0; ++n) {
+			term *= -x * x / ((2*n) * (2*n + 1));
+			T next = sum + term;
+			if (next == sum) break;
+			sum = next;
+		}
+		return sum;
+	}
+
+	/// cos(x) for x in [-pi/2, pi/2], from its Taylor series
+	template <typename T>
+	constexpr T cosSeries(T x) {
+		T term = 1, sum = 1;
+		for (int n = 1; term != 0; ++n) {
+			term *= -x * x / ((2*n - 1) * (2*n));
+			T next = sum + term;
+			if (next == sum) break;
+			sum = next;
+		}
+		return sum;
+	}
+
+	/// \brief x minus the nearest multiple of tau, in [-pi, pi].
+	///
+	/// Loses precision as x grows, like any reduction by a rounded tau. NaN when x is infinite, NaN, or so large that T
+	/// can't hold a fraction of a turn, where no bit of the angle is left.
+	template <typename T>
+	constexpr T reduce(T x) {
+		const T tau = T(6.28318530717958647692L);
+		const T pi = T(3.14159265358979323846L);
+		T turns = x / tau;
+
+		// Past half of 1 / epsilon turns, T has no bits below the half turn, which also keeps the conversion to a long
+		// long in range. The comparisons are false for NaN
+		const T exact = 1 / (2 * std::numeric_limits<T>::epsilon());
+		if (!(turns < exact && turns > -exact)) return std::numeric_limits<T>::quiet_NaN();
+
+		// Truncating a long long rounds towards zero, so the half turn rounds to the nearest
+		T k = T(static_cast<long long>(turns < 0 ? turns - T(0.5) : turns + T(0.5)));
+		T r = x - k * tau;
+		if (r > pi) r -= tau;
+		if (r < -pi) r += tau;
+		return r;
+	}
+}
+
+/// The square root of x. NaN for negative x.
+template <typename T>
+constexpr T sqrt(T x) {
+	static_assert(std::is_floating_point<T>::value, "cmath::sqrt takes a floating point number");
+	if (!MATH_IS_CONSTANT_EVALUATED()) return std::sqrt(x);
+
+	if (x != x || x < 0) return std::numeric_limits<T>::quiet_NaN();
+	if (x == 0 || x == std::numeric_limits<T>::infinity()) return x;
+
+	// Scaling by powers of 4 is exact and brings x to [1/4, 4], where Newton's iteration converges in a few steps
+	T scale = 1;
+	while (x > 4) { x /= 4; scale *= 2; }
+	while (x < T(0.25)) { x *= 4; scale /= 2; }
+
+	T y = (x + 1) / 2;
+	for (int i = 0; i < 64; ++i) {
+		T next = (y + x / y) / 2;
+		if (next == y) break;
+		y = next;
+	}
+	return y * scale;
+}
+
+/// The sine of x, in rads.
+template <typename T>
+constexpr T sin(T x) {
+	static_assert(std::is_floating_point<T>::value, "cmath::sin takes a floating point number");
+	if (!MATH_IS_CONSTANT_EVALUATED()) return std::sin(x);
+
+	const T halfPi = T(1.57079632679489661923L);
+	const T pi = T(3.14159265358979323846L);
+	// sin(pi - x) = sin(x) brings x to [-pi/2, pi/2], where the series converges fastest
+	T r = internal::reduce(x);
+	if (r != r) return r;
+	if (r > halfPi) r = pi - r;
+	if (r < -halfPi) r = -pi - r;
+	return internal::sinSeries(r);
+}
+
+/// The cosine of x, in rads.
+template <typename T>
+constexpr T cos(T x) {
+	static_assert(std::is_floating_point<T>::value, "cmath::cos takes a floating point number");
+	if (!MATH_IS_CONSTANT_EVALUATED()) return std::cos(x);
+
+	const T halfPi = T(1.57079632679489661923L);
+	const T pi = T(3.14159265358979323846L);
+	// cos(pi - x) = -cos(x) brings x to [-pi/2, pi/2]
+	T r = internal::reduce(x);
+	if (r != r) return r;
+	if (r > halfPi) return -internal::cosSeries(pi - r);
+	if (r < -halfPi) return -internal::cosSeries(-pi - r);
+	return internal::cosSeries(r);
+}
+
+}  // cmath namespace
+}  // math namespace
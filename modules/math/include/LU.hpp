@@ -0,0 +1,162 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/Matrix>
+#include <array>
+#include <cmath>
+#include <utility>
+
+namespace math {
+
+/*!
+ * \brief The LU class is the factorization P * A = L * U of a square matrix, with partial pivoting.
+ *
+ * Factoring costs O(n³) once. Then each right-hand side is solved in O(n²), and the determinant comes for free.
+ * L has a unit diagonal and is stored below the diagonal of factors(), U on and above it.
+ *
+ * At each step the line with the largest cell in the pivot column is moved up, so no multiplier is larger than one.
+ * That keeps the rounding errors small even on badly scaled matrices, which elimination without pivoting can't do.
+ */
+template <unsigned N, typename T>
+class LU {
+public:
+
+	/// Factors the matrix. Singular matrices are factored too, but can't solve anything.
+	constexpr LU(const Matrix<N, N, T>& mat);
+
+	/// Whether the matrix has no inverse, ie. a pivot is zero.
+	constexpr bool isSingular() const;
+
+	/// Determinant of the factored matrix.
+	constexpr T det() const;
+
+	/// Solves A * x = b. Returns false, leaving x untouched, if the matrix is singular.
+	constexpr bool solve(const Vector<N, T>& b, Vector<N, T>& x) const;
+
+	/// Solves A * X = B, column by column. Returns false, leaving x untouched, if the matrix is singular.
+	template <unsigned K>
+	constexpr bool solve(const Matrix<N, K, T>& b, Matrix<N, K, T>& x) const;
+
+	/// Inverse of the factored matrix. Returns false, leaving result untouched, if the matrix is singular.
+	constexpr bool inverse(Matrix<N, N, T>& result) const;
+
+	/// L and U packed in a single matrix. The unit diagonal of L is not stored.
+	constexpr const Matrix<N, N, T>& factors() const;
+
+	/// The line of A moved to each line of P * A.
+	constexpr const std::array<unsigned, N>& permutation() const;
+
+private:
+
+	/// Solves L * U * y = column j of y in place, where y holds the lines of the right-hand side already permuted.
+	template <unsigned K>
+	constexpr void substitute(Matrix<N, K, T>& y, unsigned j) const;
+
+	Matrix<N, N, T> _lu;
+	std::array<unsigned, N> _permutation;
+	T _sign;
+	bool _singular;
+
+};
+
+template <unsigned N, typename T>
+inline constexpr LU<N, T>::LU(const Matrix<N, N, T>& mat)
+	: _lu(mat), _permutation(), _sign(1), _singular(false) {
+	for (unsigned i = 0; i < N; ++i) _permutation[i] = i;
+
+	for (unsigned k = 0; k < N; ++k) {
+		unsigned pivot = k;
+		for (unsigned i = k+1; i < N; ++i)
+			if (std::abs(_lu(i, k)) > std::abs(_lu(pivot, k))) pivot = i;
+
+		if (_lu(pivot, k) == 0) {
+			// Nothing to eliminate in this column, but later ones still get factored
+			_singular = true;
+			continue;
+		}
+
+		if (pivot != k) {
+			_lu.swapline(pivot, k);
+			std::swap(_permutation[pivot], _permutation[k]);
+			_sign = -_sign;
+		}
+
+		for (unsigned i = k+1; i < N; ++i) {
+			T factor = _lu(i, k) / _lu(k, k);
+			_lu(i, k) = factor;
+			for (unsigned j = k+1; j < N; ++j) _lu(i, j) -= factor * _lu(k, j);
+		}
+	}
+}
+
+template <unsigned N, typename T>
+inline constexpr bool LU<N, T>::isSingular() const {
+	return _singular;
+}
+
+template <unsigned N, typename T>
+inline constexpr T LU<N, T>::det() const {
+	if (_singular) return 0;
+
+	T result = _sign;
+	for (unsigned i = 0; i < N; ++i) result *= _lu(i, i);
+	return result;
+}
+
+template <unsigned N, typename T>
+template <unsigned K>
+inline constexpr void LU<N, T>::substitute(Matrix<N, K, T>& y, unsigned j) const {
+	// Forward with L, whose diagonal is one, then backwards with U
+	for (unsigned i = 0; i < N; ++i)
+		for (unsigned k = 0; k < i; ++k) y(i, j) -= _lu(i, k) * y(k, j);
+
+	for (unsigned i = N; i-- > 0;) {
+		for (unsigned k = i+1; k < N; ++k) y(i, j) -= _lu(i, k) * y(k, j);
+		y(i, j) /= _lu(i, i);
+	}
+}
+
+template <unsigned N, typename T>
+inline constexpr bool LU<N, T>::solve(const Vector<N, T>& b, Vector<N, T>& x) const {
+	if (_singular) return false;
+
+	Matrix<N, 1, T> y;
+	for (unsigned i = 0; i < N; ++i) y(i, 0) = b(_permutation[i]);
+	substitute(y, 0);
+
+	for (unsigned i = 0; i < N; ++i) x(i) = y(i, 0);
+	return true;
+}
+
+template <unsigned N, typename T>
+template <unsigned K>
+inline constexpr bool LU<N, T>::solve(const Matrix<N, K, T>& b, Matrix<N, K, T>& x) const {
+	if (_singular) return false;
+
+	Matrix<N, K, T> y;
+	for (unsigned i = 0; i < N; ++i)
+		for (unsigned j = 0; j < K; ++j) y(i, j) = b(_permutation[i], j);
+
+	for (unsigned j = 0; j < K; ++j) substitute(y, j);
+
+	x = y;
+	return true;
+}
+
+template <unsigned N, typename T>
+inline constexpr bool LU<N, T>::inverse(Matrix<N, N, T>& result) const {
+	return solve(Matrix<N, N, T>::eye(), result);
+}
+
+template <unsigned N, typename T>
+inline constexpr const Matrix<N, N, T>& LU<N, T>::factors() const {
+	return _lu;
+}
+
+template <unsigned N, typename T>
+inline constexpr const std::array<unsigned, N>& LU<N, T>::permutation() const {
+	return _permutation;
+}
+
+}  // math namespace
@@ -10,75 +10,155 @@
 namespace math {
 
 enum class ReductionType;
-template <unsigned M, unsigned N>
-class Matrix {
+template <unsigned N, typename T = Real> class LU;
+template <unsigned M, unsigned N, typename T = Real> class Matrix;
+
+namespace internal {
+	/// How an expression holds an operand: matrices by reference, and expressions by value
+	template <typename E>
+	struct MatrixOperand {
+		using type = E;
+	};
+	
+	template <unsigned M, unsigned N, typename T>
+	struct MatrixOperand<Matrix<M, N, T>> {
+		using type = const Matrix<M, N, T>&;
+	};
+	
+	template <unsigned M, unsigned N, typename T, typename Op, typename L, typename R>
+	class MatrixBinary;
+	
+	template <unsigned M, unsigned N, typename T>
+	class MatrixBroadcast;
+	
+	/// The cells of a Matrix, line by line. Unlike std::array before C++17, lines can be written to in constexpr code.
+	template <unsigned M, unsigned N, typename T>
+	struct MatrixStorage {
+		T v[M][N];
+		
+		constexpr const T* operator[](unsigned i) const { return v[i]; }
+		constexpr T* operator[](unsigned i) { return v[i]; }
+	};
+} // internal
+
+/*!
+ * \brief The MatrixExpression class is the base of matrices and of the element-wise arithmetic between them.
+ *
+ * As with VectorExpression, sums, differences and products by scalars are computed in a single loop when the
+ * expression is assigned to a Matrix. Matrix products are not element-wise and compute their operands first.
+ */
+template <unsigned M, unsigned N, typename T, typename E>
+class MatrixExpression {
+public:
+
+	constexpr const E& derived() const { return static_cast<const E&>(*this); }
+
+	/// Computes the expression
+	constexpr Matrix<M, N, T> eval() const { return Matrix<M, N, T>(derived()); }
+
+	constexpr T operator()(unsigned i, unsigned j) const;
+	constexpr T operator()(unsigned x) const;
+
+	constexpr Matrix<N, M, T> transpost() const { return eval().transpost(); }
+	constexpr T det() const { return eval().det(); }
+	constexpr Matrix<N, N, T> inverse() const { return eval().inverse(); }
+
+};
+
+template <unsigned M, unsigned N, typename T>
+class Matrix : public MatrixExpression<M, N, T, Matrix<M, N, T>> {
 	static_assert(N*M > 0, "Can't make a matrix with no cells");
 public:
 
 	constexpr Matrix();
 
-	constexpr Matrix(const Matrix<M, N>& other);
-	constexpr Matrix(Matrix<M, N>& other);
+	constexpr Matrix(const Matrix<M, N, T>& other);
+	constexpr Matrix(Matrix<M, N, T>& other);
 
 	template <typename... Args>
-	constexpr Matrix(const Vector<N>& head, const Args&... tail);
+	constexpr Matrix(const Vector<N, T>& head, const Args&... tail);
 
 	template <typename... Args>
-	constexpr Matrix(const Real& head, const Args&... tail);
+	constexpr Matrix(const T& head, const Args&... tail);
 
-	constexpr const Real& operator()(unsigned i, unsigned j) const;
-	constexpr Real& operator()(unsigned i, unsigned j);
+	constexpr const T& operator()(unsigned i, unsigned j) const;
+	constexpr T& operator()(unsigned i, unsigned j);
 	
-	constexpr const Real& operator()(unsigned x) const;
-	constexpr Real& operator()(unsigned x);
+	constexpr const T& operator()(unsigned x) const;
+	constexpr T& operator()(unsigned x);
 
-	constexpr Matrix<M, N> operator+(const Matrix<M, N>& mat) const;
-	constexpr Matrix<M, N> operator-(const Matrix<M, N>& mat) const;
-	
-	constexpr Matrix<M, N> operator+() const;
-	constexpr Matrix<M, N> operator-() const;
-	
-	constexpr Matrix<M, N> operator*(const Real& real) const;
-	constexpr Matrix<M, N> operator/(const Real& real) const;
-	constexpr Matrix<M, N>& operator*=(const Real& real);
-	constexpr Matrix<M, N>& operator/=(const Real& real);
+	/// Computes an expression
+	template <typename E>
+	constexpr Matrix(const MatrixExpression<M, N, T, E>& expr);
+
+	/// Converts a matrix of another scalar type
+	template <typename U>
+	explicit constexpr Matrix(const Matrix<M, N, U>& other);
+
+	template <typename E>
+	constexpr Matrix<M, N, T>& operator=(const MatrixExpression<M, N, T, E>& expr);
+
+	constexpr const Matrix<M, N, T>& eval() const;
+
+	template <typename E>
+	constexpr Matrix<M, N, T>& operator+=(const MatrixExpression<M, N, T, E>& mat);
+	template <typename E>
+	constexpr Matrix<M, N, T>& operator-=(const MatrixExpression<M, N, T, E>& mat);
+	constexpr Matrix<M, N, T>& operator*=(const T& real);
+	constexpr Matrix<M, N, T>& operator/=(const T& real);
 	
 	/// Matrix multiplication
 	template <unsigned K>
-	constexpr Matrix<M, K> operator*(const Matrix<N, K>& mat) const;
+	constexpr Matrix<M, K, T> operator*(const Matrix<N, K, T>& mat) const;
 
-	constexpr Matrix<N, N>& operator*=(const Matrix<N, N>& mat);
+	/// Matrix multiplication in place, one line at a time
+	constexpr Matrix<N, N, T>& operator*=(const Matrix<N, N, T>& mat);
 	
 	/// Transpost of the matrix
-	constexpr Matrix<N, M> transpost() const;
+	constexpr Matrix<N, M, T> transpost() const;
 	
 	/// Creates a reduced matrix of echelon form, from line-equivalent operations
 	
 	template <typename ReductionHelper>
-	constexpr Matrix<M, N> rref(ReductionHelper&& reductionHelper, ReductionType type) const;
-	constexpr Matrix<M, N> rref(ReductionType type) const;
-	constexpr Matrix<M, N> rref(Real& real, ReductionType type) const;
-	constexpr Matrix<M, N> rref(Vector<M>& vec, ReductionType type) const;
-	constexpr Matrix<M, N> rref(Matrix<M, N>& mat, ReductionType type) const;
+	constexpr Matrix<M, N, T> rref(ReductionHelper&& reductionHelper, ReductionType type) const;
+	constexpr Matrix<M, N, T> rref(ReductionType type) const;
+	constexpr Matrix<M, N, T> rref(T& real, ReductionType type) const;
+	constexpr Matrix<M, N, T> rref(Vector<M, T>& vec, ReductionType type) const;
+	constexpr Matrix<M, N, T> rref(Matrix<M, N, T>& mat, ReductionType type) const;
 	
 	/*
 	template <typename... Args>
-	constexpr Matrix<M, N> rref(ReductionType type, Args&... args) const;
+	constexpr Matrix<M, N, T> rref(ReductionType type, Args&... args) const;
 	*/
 	/// Determinant of the matrix
-	constexpr Real det() const;
+	constexpr T det() const;
+	
+	/// Inverse of the matrix. Throws if the matrix is singular
+	constexpr Matrix<N, N, T> inverse() const;
 	
-	/// Inverse of the matrix. Assumes matrix is inversible
-	constexpr Matrix<N, N> inverse() const;
+	/// Inverse of the matrix, without throwing. Returns false, leaving result untouched, if the matrix is singular
+	constexpr bool tryInverse(Matrix<N, N, T>& result) const;
+	
+	/// \brief Inverse of an affine transform in homogeneous coordinates, whose last row is 0 0 0 1. Throws if singular
+	///
+	/// Only the 3x3 linear part is inverted, which is cheaper than inverse(). The last row is assumed, not checked.
+	constexpr Matrix<N, N, T> affineInverse() const;
+	
+	/// The same as affineInverse(), without throwing. Returns false, leaving result untouched, if the matrix is singular
+	constexpr bool tryAffineInverse(Matrix<N, N, T>& result) const;
+	
+	/// Solves (*this) * x = b, without forming the inverse. Returns false, leaving x untouched, if the matrix is singular
+	/// To solve for many right-hand sides, factor the matrix once with LU instead
+	constexpr bool solve(const Vector<M, T>& b, Vector<N, T>& x) const;
 	
 	/// Returns a null matrix.
-	constexpr static const Matrix<M, N> zeros();
+	constexpr static const Matrix<M, N, T> zeros();
 	
 	/// Returns a matrix filled with ones.
-	constexpr static const Matrix<M, N> ones();
+	constexpr static const Matrix<M, N, T> ones();
 	
 	/// Returns identity matrix.
-	constexpr static const Matrix<M, N> eye();
+	constexpr static const Matrix<M, N, T> eye();
 	
 	void swapline(unsigned a, unsigned b);
 	
@@ -86,7 +166,17 @@ public:
 
 private:
 
-	std::array<std::array<Real, N>, M> _v;
+	template <unsigned, unsigned, typename, typename, typename, typename> friend class internal::MatrixBinary;
+	template <unsigned, unsigned, typename, typename> friend class MatrixExpression;
+
+	/// Cell (i, j) as an expression operand
+	constexpr T element(unsigned i, unsigned j) const { return _v[i][j]; }
+
+	/// Replaces each cell c by Op::apply(c, e), where e is the same cell of an expression
+	template <typename Op, typename E>
+	constexpr Matrix<M, N, T>& update(const E& expr);
+
+	internal::MatrixStorage<M, N, T> _v;
 
 };
 
@@ -94,8 +184,8 @@ using Matrix2 = Matrix<2, 2>;
 using Matrix3 = Matrix<3, 3>;
 using Matrix4 = Matrix<4, 4>;
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N>::Matrix() {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T>::Matrix() : _v() {
 	for (unsigned i = 0; i < M; ++i) {
 		for (unsigned j = 0; j < N; ++j) {
 			_v[i][j] = 0;
@@ -104,44 +194,161 @@ inline constexpr Matrix<M, N>::Matrix() {
 
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N>::Matrix(const Matrix<M, N>& other) : _v(other._v) {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T>::Matrix(const Matrix<M, N, T>& other) : _v(other._v) {
 
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N>::Matrix(Matrix<M, N>& other) : _v(other._v) {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T>::Matrix(Matrix<M, N, T>& other) : _v(other._v) {
 
 }
 
-template <unsigned M, unsigned N>
+template <unsigned M, unsigned N, typename T>
 template <typename... Args>
-inline constexpr Matrix<M, N>::Matrix(const Vector<N>& head, const Args&... tail) {
-	Vector<N> vecs[] = {head, tail...};
+inline constexpr Matrix<M, N, T>::Matrix(const Vector<N, T>& head, const Args&... tail) : _v() {
+	Vector<N, T> vecs[] = {head, tail...};
 
 	for (unsigned i = 0; i < M; ++i)
 		for (unsigned j = 0; j < N; ++j)
 			_v[i][j] = vecs[j](i);
 }
 
-template <unsigned M, unsigned N>
+template <unsigned M, unsigned N, typename T>
 template <typename... Args>
-inline constexpr Matrix<M, N>::Matrix(const Real& head, const Args&... tail) {
-	Real reals[] = {Real(head), Real(tail)...};
+inline constexpr Matrix<M, N, T>::Matrix(const T& head, const Args&... tail) : _v() {
+	T reals[] = {T(head), T(tail)...};
 
 	for (unsigned i = 0; i < M; ++i)
 		for (unsigned j = 0; j < N; ++j)
 			_v[i][j] = reals[i*N+j];
 }
 
-template <unsigned M, unsigned N>
-constexpr Matrix<M, N> operator*(const Real& real, const Matrix<M, N>& matrix) {
-	return matrix * real;
+template <unsigned M, unsigned N, typename T>
+template <typename E>
+inline constexpr Matrix<M, N, T>::Matrix(const MatrixExpression<M, N, T, E>& expr) : _v() {
+	for (unsigned i = 0; i < M; ++i)
+		for (unsigned j = 0; j < N; ++j)
+			_v[i][j] = expr.derived().element(i, j);
+}
+
+template <unsigned M, unsigned N, typename T>
+template <typename U>
+inline constexpr Matrix<M, N, T>::Matrix(const Matrix<M, N, U>& other) : _v() {
+	for (unsigned i = 0; i < M; ++i)
+		for (unsigned j = 0; j < N; ++j)
+			_v[i][j] = T(other(i, j));
+}
+
+template <unsigned M, unsigned N, typename T>
+template <typename E>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::operator=(const MatrixExpression<M, N, T, E>& expr) {
+	// Each cell only depends on the same cell of the operands, so expr may refer to this matrix
+	for (unsigned i = 0; i < M; ++i)
+		for (unsigned j = 0; j < N; ++j)
+			_v[i][j] = expr.derived().element(i, j);
+	return *this;
+}
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr const Matrix<M, N, T>& Matrix<M, N, T>::eval() const {
+	return *this;
+}
+
+namespace internal {
+	/// An element-wise operation between two matrix expressions
+	template <unsigned M, unsigned N, typename T, typename Op, typename L, typename R>
+	class MatrixBinary : public MatrixExpression<M, N, T, MatrixBinary<M, N, T, Op, L, R>> {
+	public:
+		constexpr MatrixBinary(const L& l, const R& r) : _l(l), _r(r) {}
+		
+		constexpr T element(unsigned i, unsigned j) const { return Op::apply(_l.element(i, j), _r.element(i, j)); }
+		
+	private:
+		typename MatrixOperand<L>::type _l;
+		typename MatrixOperand<R>::type _r;
+	};
+	
+	/// A scalar, as a matrix with the same value in every cell
+	template <unsigned M, unsigned N, typename T>
+	class MatrixBroadcast : public MatrixExpression<M, N, T, MatrixBroadcast<M, N, T>> {
+	public:
+		constexpr explicit MatrixBroadcast(T real) : _real(real) {}
+		
+		constexpr T element(unsigned, unsigned) const { return _real; }
+		
+	private:
+		T _real;
+	};
+} // internal
+
+template <unsigned M, unsigned N, typename T, typename E>
+inline constexpr T MatrixExpression<M, N, T, E>::operator()(unsigned i, unsigned j) const {
+#ifdef DEBUG
+	if (i >= M || j >= N) throw std::logic_error("Invalid index");
+#endif
+
+	return derived().element(i, j);
+}
+
+template <unsigned M, unsigned N, typename T, typename E>
+inline constexpr T MatrixExpression<M, N, T, E>::operator()(unsigned x) const {
+#ifdef DEBUG
+	if (x >= N*M) throw std::logic_error("Invalid index");
+#endif
+
+	return derived().element(x/N, x%N);
+}
+
+template <unsigned M, unsigned N, typename T, typename L, typename R>
+constexpr internal::MatrixBinary<M, N, T, internal::Add, L, R> operator+(const MatrixExpression<M, N, T, L>& a, const MatrixExpression<M, N, T, R>& b) {
+	return {a.derived(), b.derived()};
+}
+
+template <unsigned M, unsigned N, typename T, typename L, typename R>
+constexpr internal::MatrixBinary<M, N, T, internal::Subtract, L, R> operator-(const MatrixExpression<M, N, T, L>& a, const MatrixExpression<M, N, T, R>& b) {
+	return {a.derived(), b.derived()};
+}
+
+template <unsigned M, unsigned N, typename T, typename E>
+constexpr internal::MatrixBinary<M, N, T, internal::Multiply, E, internal::MatrixBroadcast<M, N, T>> operator*(const MatrixExpression<M, N, T, E>& mat, const internal::NonDeduced<T>& real) {
+	return {mat.derived(), internal::MatrixBroadcast<M, N, T>(real)};
+}
+
+template <unsigned M, unsigned N, typename T, typename E>
+constexpr internal::MatrixBinary<M, N, T, internal::Multiply, E, internal::MatrixBroadcast<M, N, T>> operator*(const internal::NonDeduced<T>& real, const MatrixExpression<M, N, T, E>& mat) {
+	return mat * real;
+}
+
+template <unsigned M, unsigned N, typename T, typename E>
+constexpr internal::MatrixBinary<M, N, T, internal::Divide, E, internal::MatrixBroadcast<M, N, T>> operator/(const MatrixExpression<M, N, T, E>& mat, const internal::NonDeduced<T>& real) {
+#ifdef DEBUG
+	if (real == 0)
+		throw std::logic_error("Can't divide by zero");
+#endif
+
+	return {mat.derived(), internal::MatrixBroadcast<M, N, T>(real)};
+}
+
+template <unsigned M, unsigned N, typename T, typename E>
+constexpr E operator+(const MatrixExpression<M, N, T, E>& mat) {
+	return mat.derived();
 }
 
-template <unsigned M, unsigned N>
-constexpr Vector<M> operator*(const Matrix<M, N>& mat, const Vector<N>& vec) {
-	Vector<M> result;
+template <unsigned M, unsigned N, typename T, typename E>
+constexpr internal::MatrixBinary<M, N, T, internal::Multiply, E, internal::MatrixBroadcast<M, N, T>> operator-(const MatrixExpression<M, N, T, E>& mat) {
+	return mat * (-1);
+}
+
+/// Matrix multiplication of expressions, which are computed first
+template <unsigned M, unsigned N, unsigned K, typename T, typename L, typename R>
+constexpr Matrix<M, K, T> operator*(const MatrixExpression<M, N, T, L>& a, const MatrixExpression<N, K, T, R>& b) {
+	return a.derived().eval() * b.derived().eval();
+}
+
+template <unsigned M, unsigned N, typename T>
+constexpr Vector<M, T> operator*(const Matrix<M, N, T>& mat, const Vector<N, T>& vec) {
+	Vector<M, T> result;
 	for (unsigned i = 0; i < M; ++i) {
 		for (unsigned j = 0; j < N; ++j) {
 			result(i) += mat(i, j) * vec(j);
@@ -151,8 +358,14 @@ constexpr Vector<M> operator*(const Matrix<M, N>& mat, const Vector<N>& vec) {
 	return result;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr const Real& Matrix<M, N>::operator()(unsigned i, unsigned j) const {
+/// Product of expressions, which are computed first
+template <unsigned M, unsigned N, typename T, typename L, typename R>
+constexpr Vector<M, T> operator*(const MatrixExpression<M, N, T, L>& mat, const VectorExpression<N, T, R>& vec) {
+	return mat.derived().eval() * vec.derived().eval();
+}
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr const T& Matrix<M, N, T>::operator()(unsigned i, unsigned j) const {
 #ifdef DEBUG
 	if (i >= M || j >= N) throw std::logic_error("Invalid index");
 #endif
@@ -160,8 +373,8 @@ inline constexpr const Real& Matrix<M, N>::operator()(unsigned i, unsigned j) co
 	return _v[i][j];
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Real& Matrix<M, N>::operator()(unsigned i, unsigned j) {
+template <unsigned M, unsigned N, typename T>
+inline constexpr T& Matrix<M, N, T>::operator()(unsigned i, unsigned j) {
 #ifdef DEBUG
 	if (i >= M || j >= N) throw std::logic_error("Invalid index");
 #endif
@@ -169,8 +382,8 @@ inline constexpr Real& Matrix<M, N>::operator()(unsigned i, unsigned j) {
 	return _v[i][j];
 }
 
-template <unsigned M, unsigned N>
-inline constexpr const Real& Matrix<M, N>::operator()(unsigned x) const {
+template <unsigned M, unsigned N, typename T>
+inline constexpr const T& Matrix<M, N, T>::operator()(unsigned x) const {
 #ifdef DEBUG
 	if (x >= N*M) throw std::logic_error("Invalid index");
 #endif
@@ -178,8 +391,8 @@ inline constexpr const Real& Matrix<M, N>::operator()(unsigned x) const {
 	return _v[x/N][x%N];
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Real& Matrix<M, N>::operator()(unsigned x) {
+template <unsigned M, unsigned N, typename T>
+inline constexpr T& Matrix<M, N, T>::operator()(unsigned x) {
 #ifdef DEBUG
 	if (x >= N*M) throw std::logic_error("Invalid index");
 #endif
@@ -187,79 +400,46 @@ inline constexpr Real& Matrix<M, N>::operator()(unsigned x) {
 	return _v[x/N][x%N];
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator+(const Matrix<M, N>& mat) const {
-	Matrix<M, N> result;
-	for (unsigned i = 0; i < M; ++i) {
-		for (unsigned j = 0; j < N; ++j) {
-			result(i, j) += _v[i][j] + mat(i, j);
-		}
-	}
-	return result;
-}	
-
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator-(const Matrix<M, N>& mat) const {
-	Matrix<M, N> result;
-	for (unsigned i = 0; i < M; ++i) {
-		for (unsigned j = 0; j < N; ++j) {
-			result(i, j) += _v[i][j] - mat(i, j);
-		}
-	}
-	return result;
-}
-
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator+() const {
-	return (*this);
+template <unsigned M, unsigned N, typename T>
+template <typename E>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::operator+=(const MatrixExpression<M, N, T, E>& mat) {
+	return update<internal::Add>(mat.derived());
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator-() const {
-	return (*this) * (-1);
+template <unsigned M, unsigned N, typename T>
+template <typename E>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::operator-=(const MatrixExpression<M, N, T, E>& mat) {
+	return update<internal::Subtract>(mat.derived());
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator*(const Real& real) const {
-	Matrix<M, N> result;
-	for (unsigned i = 0; i < M; ++i) {
-		for (unsigned j = 0; j < N; ++j) {
-			result(i, j) += _v[i][j] * real;
-		}
-	}
-	return result;
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::operator*=(const T& real) {
+	return update<internal::Multiply>(internal::MatrixBroadcast<M, N, T>(real));
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::operator/(const Real& real) const {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::operator/=(const T& real) {
 #ifdef DEBUG
 	if (real == 0)
 		throw std::logic_error("Can't divide by zero");
 #endif
 
-	Matrix<M, N> result;
-	for (unsigned i = 0; i < M; ++i) {
-		for (unsigned j = 0; j < N; ++j) {
-			result(i, j) += _v[i][j] / real;
-		}
-	}
-	return result;
+	return update<internal::Divide>(internal::MatrixBroadcast<M, N, T>(real));
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N>& Matrix<M, N>::operator*=(const Real& real) {
-	return (*this) = (*this) * real;
-}
-
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N>& Matrix<M, N>::operator/=(const Real& real) {
-	return (*this) = (*this) / real;
+template <unsigned M, unsigned N, typename T>
+template <typename Op, typename E>
+inline constexpr Matrix<M, N, T>& Matrix<M, N, T>::update(const E& expr) {
+	for (unsigned i = 0; i < M; ++i)
+		for (unsigned j = 0; j < N; ++j)
+			_v[i][j] = Op::apply(_v[i][j], expr.element(i, j));
+	return *this;
 }
 
-template <unsigned M, unsigned N>
+template <unsigned M, unsigned N, typename T>
 template <unsigned K>
-inline constexpr Matrix<M, K> Matrix<M, N>::operator*(const Matrix<N, K>& mat) const {
-	Matrix<M, K> result;
+inline constexpr Matrix<M, K, T> Matrix<M, N, T>::operator*(const Matrix<N, K, T>& mat) const {
+	Matrix<M, K, T> result;
 	for (unsigned i = 0; i < M; ++i) {
 		for (unsigned k = 0; k < K; ++k) {
 			for (unsigned j = 0; j < N; ++j) {
@@ -270,15 +450,27 @@ inline constexpr Matrix<M, K> Matrix<M, N>::operator*(const Matrix<N, K>& mat) c
 	return result;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<N, N>& Matrix<M, N>::operator*=(const Matrix<N, N>& mat) {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<N, N, T>& Matrix<M, N, T>::operator*=(const Matrix<N, N, T>& mat) {
 	static_assert(N == M, "Matrix must be squared for operator*= to work");
-	return (*this) = (*this) * mat;
+	if (&mat == this)
+		return (*this) = (*this) * mat;
+	
+	// Each line of the product only depends on the same line of this matrix
+	for (unsigned i = 0; i < M; ++i) {
+		T line[N] = {};
+		for (unsigned j = 0; j < N; ++j)
+			for (unsigned k = 0; k < N; ++k)
+				line[k] += _v[i][j] * mat(j, k);
+		for (unsigned k = 0; k < N; ++k)
+			_v[i][k] = line[k];
+	}
+	return *this;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<N, M> Matrix<M, N>::transpost() const {
-	Matrix<N, M> result;
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<N, M, T> Matrix<M, N, T>::transpost() const {
+	Matrix<N, M, T> result;
 	for (unsigned i = 0; i < M; ++i) {
 		for (unsigned j = 0; j < N; ++j) {
 			result(j, i) = _v[i][j];
@@ -288,34 +480,35 @@ inline constexpr Matrix<N, M> Matrix<M, N>::transpost() const {
 }
 
 namespace internal {
-	template <unsigned M, unsigned N>
+	template <unsigned M, unsigned N, typename T>
 	struct ReductionHelperWithMatrix {
-		Matrix<M, N>& mat;
+		Matrix<M, N, T>& mat;
 		
 		void applyLineSwap(unsigned a, unsigned b) {mat.swapline(a, b);}
 		void applySubtractLines(unsigned a, unsigned b) {
 			for (unsigned j = 0; j < N; ++j) mat(a, j) -= mat(b, j);
 		}
 		
-		void applyScalar(unsigned a, Real s) {
+		void applyScalar(unsigned a, T s) {
 			for (unsigned j = 0; j < N; ++j) mat(a, j) *= s;
 		}
 	};
 	
-	template <unsigned M>
+	template <unsigned M, typename T>
 	struct ReductionHelperWithVector {
-		Vector<M>& vec;
+		Vector<M, T>& vec;
 		void applyLineSwap(unsigned a, unsigned b) {vec.swapline(a, b);}
 		void applySubtractLines(unsigned a, unsigned b) {vec(a) -= vec(b);}
-		void applyScalar(unsigned a, Real s) {vec(a) *= s;}
+		void applyScalar(unsigned a, T s) {vec(a) *= s;}
 	};
 	
+	template <typename T>
 	struct ReductionHelperWithReal {
-		Real& real;
+		T& real;
 		
 		void applyLineSwap(unsigned, unsigned) { real *= (-1);}
 		void applySubtractLines(unsigned, unsigned) {}
-		void applyScalar(unsigned, Real s) {real *= s;}
+		void applyScalar(unsigned, T s) {real *= s;}
 	};
 	
 	struct ReductionHelperWithNothing {
@@ -361,17 +554,17 @@ namespace internal {
 	
 	template <>
 	struct ReductionHelperGetter<Real> {
-		static ReductionHelperWithReal get(Real& x) { return {x}; }
+		static ReductionHelperWithReal<Real> get(Real& x) { return {x}; }
 	};
 	
-	template <unsigned M>
-	struct ReductionHelperGetter<Vector<M>> {
-		static ReductionHelperWithVector<M> get(Vector<M>& x) { return {x}; }
+	template <unsigned M, typename T>
+	struct ReductionHelperGetter<Vector<M, T>> {
+		static ReductionHelperWithVector<M, T> get(Vector<M, T>& x) { return {x}; }
 	};
 	
-	template <unsigned M, unsigned N>
-	struct ReductionHelperGetter<Matrix<M, N>> {
-		static ReductionHelperWithMatrix<M, N> get(Matrix<M, N>& x) { return {x}; }
+	template <unsigned M, unsigned N, typename T>
+	struct ReductionHelperGetter<Matrix<M, N, T>> {
+		static ReductionHelperWithMatrix<M, N, T> get(Matrix<M, N, T>& x) { return {x}; }
 	};
 	
 	
@@ -384,40 +577,40 @@ enum class ReductionType {
 };
 
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionType type) const {
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(ReductionType type) const {
 	return rref(internal::ReductionHelperWithNothing{}, type);
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(Real& real, ReductionType type) const {
-	return rref(internal::ReductionHelperWithReal{real}, type);
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(T& real, ReductionType type) const {
+	return rref(internal::ReductionHelperWithReal<T>{real}, type);
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(Vector<M>& vec, ReductionType type) const {
-	return rref(internal::ReductionHelperWithVector<M>{vec}, type);
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(Vector<M, T>& vec, ReductionType type) const {
+	return rref(internal::ReductionHelperWithVector<M, T>{vec}, type);
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(Matrix<M, N>& mat, ReductionType type) const {
-	return rref(internal::ReductionHelperWithMatrix<M, N>{mat}, type);
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(Matrix<M, N, T>& mat, ReductionType type) const {
+	return rref(internal::ReductionHelperWithMatrix<M, N, T>{mat}, type);
 }
 
 /*
-template <unsigned M, unsigned N>
+template <unsigned M, unsigned N, typename T>
 template <typename... Args>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionType type, Args&... args) const {
-	Matrix<M, N> result = *this;
-	//auto helper = internal::ReductionHelperGetter<Matrix<M, N>, Args...>::get(result, args...);*/
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(ReductionType type, Args&... args) const {
+	Matrix<M, N, T> result = *this;
+	//auto helper = internal::ReductionHelperGetter<Matrix<M, N, T>, Args...>::get(result, args...);*/
 
 
-template <unsigned M, unsigned N>
+template <unsigned M, unsigned N, typename T>
 template <typename ReductionHelper>
-inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelper, ReductionType type) const {
+inline constexpr Matrix<M, N, T> Matrix<M, N, T>::rref(ReductionHelper&& reductionHelper, ReductionType type) const {
 	
-	Matrix<M, N> result = *this;
-	internal::ReductionHelperWithMatrix<M, N> helper{result};
+	Matrix<M, N, T> result = *this;
+	internal::ReductionHelperWithMatrix<M, N, T> helper{result};
 	
 	// Iterate until run out of (rows or cols).
 	for (unsigned k = 0; k < M-1 or k < N-1; ++k) {
@@ -426,7 +619,7 @@ inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelp
 		bool null = false;
 		
 		// Check if main pivot is zero. If it is, fix it!
-		Real pivot = 0;
+		T pivot = 0;
 		unsigned ip = 0;
 		unsigned jp = 0;
 		switch (type) {
@@ -440,7 +633,7 @@ inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelp
 		if (pivot == 0) {
 			null = true;
 			for (unsigned i = k+1; i < M; ++i) {
-				Real cell = 0;
+				T cell = 0;
 				unsigned ic = 0;
 				unsigned jc = 0;
 				switch (type) {
@@ -464,7 +657,7 @@ inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelp
 		if (null) continue;
 	
 		for (unsigned i = k+1; i < M; ++i) {
-			Real cell = 0;
+			T cell = 0;
 			unsigned ic = 0;
 			unsigned jc = 0;
 			switch (type) {
@@ -479,7 +672,7 @@ inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelp
 			if (cell == 0) continue;
 			
 			// Reduce the matrix
-			Real value = pivot / cell;
+			T value = pivot / cell;
 			
 			reductionHelper.applyScalar(ic, value);
 			reductionHelper.applySubtractLines(ic, ip);
@@ -492,42 +685,185 @@ inline constexpr Matrix<M, N> Matrix<M, N>::rref(ReductionHelper&& reductionHelp
 	return result;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr Real Matrix<M, N>::det() const {
+namespace internal {
+	/// Determinant and inverse by LU factorization, for any size
+	template <unsigned N, typename T>
+	struct Inversion {
+		static constexpr T det(const Matrix<N, N, T>& mat) {
+			return LU<N, T>(mat).det();
+		}
+		
+		static constexpr bool tryInverse(const Matrix<N, N, T>& mat, Matrix<N, N, T>& result) {
+			return LU<N, T>(mat).inverse(result);
+		}
+	};
+	
+	/// Cofactor formulas for the sizes used everywhere. No loops, no branches but the singularity check
+	template <typename T>
+	struct Inversion<2, T> {
+		static constexpr T det(const Matrix<2, 2, T>& m) {
+			return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+		}
+		
+		static constexpr bool tryInverse(const Matrix<2, 2, T>& m, Matrix<2, 2, T>& result) {
+			T d = det(m);
+			if (d == 0) return false;
+			
+			T inv = 1 / d;
+			result = Matrix<2, 2, T>{
+				 m(1, 1) * inv, -m(0, 1) * inv,
+				-m(1, 0) * inv,  m(0, 0) * inv
+			};
+			return true;
+		}
+	};
+	
+	template <typename T>
+	struct Inversion<3, T> {
+		static constexpr T det(const Matrix<3, 3, T>& m) {
+			return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+			     - m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+			     + m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+		}
+		
+		static constexpr bool tryInverse(const Matrix<3, 3, T>& m, Matrix<3, 3, T>& result) {
+			T c00 = m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1);
+			T c01 = m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2);
+			T c02 = m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0);
+			
+			T d = m(0, 0) * c00 + m(0, 1) * c01 + m(0, 2) * c02;
+			if (d == 0) return false;
+			
+			T inv = 1 / d;
+			result = Matrix<3, 3, T>{
+				c00 * inv, (m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2)) * inv, (m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1)) * inv,
+				c01 * inv, (m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0)) * inv, (m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2)) * inv,
+				c02 * inv, (m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1)) * inv, (m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)) * inv
+			};
+			return true;
+		}
+	};
+	
+	template <typename T>
+	struct Inversion<4, T> {
+		/// The 2x2 minors of the two upper and the two lower rows, shared by det() and tryInverse()
+		struct Minors {
+			T s0, s1, s2, s3, s4, s5;
+			T c0, c1, c2, c3, c4, c5;
+			
+			constexpr Minors(const Matrix<4, 4, T>& m)
+				: s0(m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1)), s1(m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2)),
+				  s2(m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3)), s3(m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2)),
+				  s4(m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3)), s5(m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3)),
+				  c0(m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1)), c1(m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2)),
+				  c2(m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3)), c3(m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2)),
+				  c4(m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3)), c5(m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3)) {}
+			
+			constexpr T det() const {
+				return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			}
+		};
+		
+		static constexpr T det(const Matrix<4, 4, T>& m) {
+			return Minors(m).det();
+		}
+		
+		static constexpr bool tryInverse(const Matrix<4, 4, T>& m, Matrix<4, 4, T>& result) {
+			Minors n(m);
+			T d = n.det();
+			if (d == 0) return false;
+			
+			T inv = 1 / d;
+			result = Matrix<4, 4, T>{
+				( m(1, 1) * n.c5 - m(1, 2) * n.c4 + m(1, 3) * n.c3) * inv,
+				(-m(0, 1) * n.c5 + m(0, 2) * n.c4 - m(0, 3) * n.c3) * inv,
+				( m(3, 1) * n.s5 - m(3, 2) * n.s4 + m(3, 3) * n.s3) * inv,
+				(-m(2, 1) * n.s5 + m(2, 2) * n.s4 - m(2, 3) * n.s3) * inv,
+				
+				(-m(1, 0) * n.c5 + m(1, 2) * n.c2 - m(1, 3) * n.c1) * inv,
+				( m(0, 0) * n.c5 - m(0, 2) * n.c2 + m(0, 3) * n.c1) * inv,
+				(-m(3, 0) * n.s5 + m(3, 2) * n.s2 - m(3, 3) * n.s1) * inv,
+				( m(2, 0) * n.s5 - m(2, 2) * n.s2 + m(2, 3) * n.s1) * inv,
+				
+				( m(1, 0) * n.c4 - m(1, 1) * n.c2 + m(1, 3) * n.c0) * inv,
+				(-m(0, 0) * n.c4 + m(0, 1) * n.c2 - m(0, 3) * n.c0) * inv,
+				( m(3, 0) * n.s4 - m(3, 1) * n.s2 + m(3, 3) * n.s0) * inv,
+				(-m(2, 0) * n.s4 + m(2, 1) * n.s2 - m(2, 3) * n.s0) * inv,
+				
+				(-m(1, 0) * n.c3 + m(1, 1) * n.c1 - m(1, 2) * n.c0) * inv,
+				( m(0, 0) * n.c3 - m(0, 1) * n.c1 + m(0, 2) * n.c0) * inv,
+				(-m(3, 0) * n.s3 + m(3, 1) * n.s1 - m(3, 2) * n.s0) * inv,
+				( m(2, 0) * n.s3 - m(2, 1) * n.s1 + m(2, 2) * n.s0) * inv
+			};
+			return true;
+		}
+	};
+} // internal
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr T Matrix<M, N, T>::det() const {
 	static_assert(M == N, "Matrix must be squared for det() to work");
+	return internal::Inversion<M, T>::det(*this);
+}
 
-	Real result = 1;
-	Matrix<M, M> reduced = rref(result, ReductionType::LowerLeft);
-	for (unsigned i = 0; i < M; ++i) result *= reduced(i, i);
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<N, N, T> Matrix<M, N, T>::inverse() const {
+	Matrix<N, N, T> result;
+	if (!tryInverse(result)) throw std::logic_error("Matrix is non invertible");
 	return result;
 }
 
+template <unsigned M, unsigned N, typename T>
+inline constexpr bool Matrix<M, N, T>::tryInverse(Matrix<N, N, T>& result) const {
+	static_assert(M == N, "Matrix must be squared for tryInverse() to work");
+	return internal::Inversion<M, T>::tryInverse(*this, result);
+}
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr Matrix<N, N, T> Matrix<M, N, T>::affineInverse() const {
+	Matrix<N, N, T> result;
+	if (!tryAffineInverse(result)) throw std::logic_error("Matrix is non invertible");
+	return result;
+}
 
-template <unsigned M, unsigned N>
-inline constexpr Matrix<N, N> Matrix<M, N>::inverse() const {
-	static_assert(M == N, "Matrix must be squared for inverse() to work");
+template <unsigned M, unsigned N, typename T>
+inline constexpr bool Matrix<M, N, T>::tryAffineInverse(Matrix<N, N, T>& result) const {
+	static_assert(M == 4 && N == 4, "tryAffineInverse() only works on 4x4 matrices");
 	
-	Real d = det();
-	if (d == 0) throw std::logic_error("Matrix is non invertible");
+	// The inverse of [A t; 0 1] is [A^-1 -A^-1*t; 0 1], so only the 3x3 block is inverted
+	Matrix<3, 3, T> linear;
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			linear(i, j) = _v[i][j];
 	
-	Matrix<M, M> identity = Matrix<M,M>::eye();
-	Matrix<M, M> firstReduced = rref(identity, ReductionType::LowerLeft);
-	Matrix<M, M> secondReduced = firstReduced.rref(identity, ReductionType::UpperRight);
-	for (unsigned i = 0; i < M; ++i) {
-		for (unsigned j = 0; j < N; ++j) identity(i, j) /= secondReduced(i, i);
-	}
+	Matrix<3, 3, T> inverted;
+	if (!internal::Inversion<3, T>::tryInverse(linear, inverted)) return false;
 	
-	return identity;
+	result = Matrix<4, 4, T>::eye();
+	for (unsigned i = 0; i < 3; ++i) {
+		for (unsigned j = 0; j < 3; ++j) {
+			result(i, j) = inverted(i, j);
+			result(i, 3) -= inverted(i, j) * _v[j][3];
+		}
+	}
+	return true;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr const Matrix<M, N> Matrix<M, N>::zeros() {
+template <unsigned M, unsigned N, typename T>
+inline constexpr bool Matrix<M, N, T>::solve(const Vector<M, T>& b, Vector<N, T>& x) const {
+	static_assert(M == N, "Matrix must be squared for solve() to work");
+	return LU<N, T>(*this).solve(b, x);
+}
+
+template <unsigned M, unsigned N, typename T>
+inline constexpr const Matrix<M, N, T> Matrix<M, N, T>::zeros() {
 	return Matrix();
 }
 
-template <unsigned M, unsigned N>
-inline constexpr const Matrix<M, N> Matrix<M, N>::ones() {
-	Matrix<M, N> result;
+template <unsigned M, unsigned N, typename T>
+inline constexpr const Matrix<M, N, T> Matrix<M, N, T>::ones() {
+	Matrix<M, N, T> result;
 	for (unsigned i = 0; i < M; ++i) {
 		for (unsigned j = 0; j < N; ++j) {
 			result(i, j) = 1;
@@ -536,18 +872,20 @@ inline constexpr const Matrix<M, N> Matrix<M, N>::ones() {
 	return result;
 }
 
-template <unsigned M, unsigned N>
-inline constexpr const Matrix<M, N> Matrix<M, N>::eye() {
-	Matrix<M, N> result;
+template <unsigned M, unsigned N, typename T>
+inline constexpr const Matrix<M, N, T> Matrix<M, N, T>::eye() {
+	Matrix<M, N, T> result;
 	for (unsigned x = 0; x < M*N; ++x)
 		result(x) = (x % (N+1) ? 0 : 1);
 	return result;
 }
 
-template <unsigned M, unsigned N>
-void Matrix<M, N>::swapline(unsigned a, unsigned b) {
+template <unsigned M, unsigned N, typename T>
+void Matrix<M, N, T>::swapline(unsigned a, unsigned b) {
 	for (unsigned j = 0; j < N; ++j) 
 		std::swap(_v[a][j], _v[b][j]);
 }
 
 }  // math namespace
+
+#include <math/LU>
@@ -2,7 +2,18 @@
 
 namespace math {
 
+#ifdef MATH_SINGLE_PRECISION
+// SIMD packs hold doubles, so single precision builds run on the scalar paths
+#ifndef MATH_NO_SIMD
+#define MATH_NO_SIMD
+#endif
+
+using Real = float;
+#else
 using Real = double;
+#endif
 
-}
+/// Sums over many Reals, such as volumes, which keep double precision even when Real is float
+using Accumulator = double;
 
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/Simd>
+#include <math/ThreadPool>
+#include <math/SymmetricEigen>
+#include <cstddef>
+
+namespace math {
+
+namespace internal {
+	/// \brief Zeroes b(i, j) with a Givens rotation of rows j and i, accumulated into columns j and i of u.
+	///
+	/// Takes the QR decomposition of b one cell at a time. A null column gives no rotation.
+	inline void givens3(simd::Pack b[3][3], simd::Pack u[3][3], unsigned i, unsigned j) {
+		const simd::Pack zero = simd::broadcast(0);
+		const simd::Pack one = simd::broadcast(1);
+		simd::Pack x = b[j][j], y = b[i][j];
+		simd::Pack r = simd::sqrt(x*x + y*y);
+		simd::Mask null = r == zero;
+		simd::Pack c = simd::select(null, one, x / r);
+		simd::Pack s = simd::select(null, zero, y / r);
+
+		for (unsigned k = 0; k < 3; ++k) {
+			simd::Pack bjk = b[j][k], bik = b[i][k];
+			b[j][k] = c * bjk + s * bik;
+			b[i][k] = c * bik - s * bjk;
+
+			simd::Pack ukj = u[k][j], uki = u[k][i];
+			u[k][j] = c * ukj + s * uki;
+			u[k][i] = c * uki - s * ukj;
+		}
+	}
+}
+
+/*!
+ * \brief The SVD class is the singular value decomposition A = U * S * V^T of a 3x3 matrix.
+ *
+ * S is diagonal, holding the singular values, and U and V are orthogonal. V is the rotation that diagonalizes A^T * A,
+ * from SymmetricEigen3. Then A * V is split by Givens rotations into U times an upper triangle, whose diagonal is S.
+ * Unlike square roots of the eigenvalues of A^T * A, this keeps the small singular values accurate, and U orthonormal
+ * when A is singular.
+ *
+ * Like SymmetricEigen3, it has no branches, and decompose() runs simd::width matrices per instruction.
+ */
+class SVD {
+public:
+
+	/// Decomposes mat.
+	explicit SVD(const Matrix3& mat);
+
+	/// The left singular vectors, as columns. A rotation when the determinant of the matrix is not negative, a
+	/// reflection otherwise.
+	const Matrix3& u() const;
+
+	/// The singular values, not negative and in decreasing order.
+	const Vector3& singularValues() const;
+
+	/// The right singular vectors, as the columns of a rotation matrix.
+	const Matrix3& v() const;
+
+	/// \brief Decomposes count matrices, writing count items to u, singularValues and v.
+	///
+	/// When a pool is given, the matrices are split between its threads.
+	static void decompose(const Matrix3* matrices, std::size_t count, Matrix3* u, Vector3* singularValues, Matrix3* v,
+	                      ThreadPool* pool = nullptr);
+
+private:
+
+	Matrix3 _u;
+	Vector3 _singularValues;
+	Matrix3 _v;
+
+};
+
+inline SVD::SVD(const Matrix3& mat) {
+	decompose(&mat, 1, &_u, &_singularValues, &_v);
+}
+
+inline const Matrix3& SVD::u() const {
+	return _u;
+}
+
+inline const Vector3& SVD::singularValues() const {
+	return _singularValues;
+}
+
+inline const Matrix3& SVD::v() const {
+	return _v;
+}
+
+inline void SVD::decompose(const Matrix3* matrices, std::size_t count, Matrix3* u, Vector3* singularValues, Matrix3* v,
+                           ThreadPool* pool) {
+	internal::forLanes(count, pool, [&](std::size_t first, unsigned lanes) {
+		simd::Pack m[3][3], a[3][3], w[3][3];
+		for (unsigned i = 0; i < 3; ++i)
+			for (unsigned j = 0; j < 3; ++j)
+				m[i][j] = internal::gather(matrices + first, lanes, i, j);
+
+		// V from the eigenvectors of A^T * A, with the largest singular values first
+		for (unsigned i = 0; i < 3; ++i) {
+			for (unsigned j = i; j < 3; ++j)
+				a[i][j] = a[j][i] = m[0][i]*m[0][j] + m[1][i]*m[1][j] + m[2][i]*m[2][j];
+			for (unsigned j = 0; j < 3; ++j)
+				w[i][j] = simd::broadcast(Real(i == j));
+		}
+		internal::jacobi3(a, w);
+
+		// A * V = U * R, R upper triangular with the singular values on its diagonal
+		simd::Pack b[3][3], q[3][3];
+		for (unsigned i = 0; i < 3; ++i) {
+			for (unsigned j = 0; j < 3; ++j) {
+				b[i][j] = m[i][0]*w[0][j] + m[i][1]*w[1][j] + m[i][2]*w[2][j];
+				q[i][j] = simd::broadcast(Real(i == j));
+			}
+		}
+		internal::givens3(b, q, 1, 0);
+		internal::givens3(b, q, 2, 0);
+		internal::givens3(b, q, 2, 1);
+
+		// Only the last diagonal cell can be negative, with the determinant. U takes its sign
+		simd::Mask negative = b[2][2] < simd::broadcast(0);
+		b[2][2] = simd::abs(b[2][2]);
+		for (unsigned k = 0; k < 3; ++k)
+			q[k][2] = simd::select(negative, -q[k][2], q[k][2]);
+
+		for (unsigned i = 0; i < 3; ++i) {
+			internal::scatter(b[i][i], singularValues + first, lanes, i);
+			for (unsigned j = 0; j < 3; ++j) {
+				internal::scatter(q[i][j], u + first, lanes, i, j);
+				internal::scatter(w[i][j], v + first, lanes, i, j);
+			}
+		}
+	});
+}
+
+}  // math namespace
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <math/Real>
+#include <cmath>
+#include <type_traits>
+
+#if !defined(MATH_NO_SIMD) && defined(__AVX__)
+#define MATH_SIMD_AVX
+#include <immintrin.h>
+#elif !defined(MATH_NO_SIMD) && defined(__SSE2__)
+#define MATH_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+// Tells constant evaluation apart from running code, so constexpr functions can take SIMD paths at run time only.
+// Compilers without the builtin always take the scalar paths.
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+#ifndef MATH_IS_CONSTANT_EVALUATED
+#define MATH_IS_CONSTANT_EVALUATED() true
+#endif
+
+namespace math {
+
+/*!
+ * \brief Thin wrappers over the SIMD registers of the target, holding several Reals side by side.
+ *
+ * Pack holds simd::width lanes and every operation works on all of them at once. The widest instruction set
+ * enabled at compile time is used: AVX (4 lanes), then SSE2 (2 lanes). Without any, or with MATH_NO_SIMD
+ * defined, a Pack is a single Real and the same code runs as plain scalar code.
+ *
+ * Every operation rounds exactly like its scalar counterpart, so code written on packs gives, lane by lane,
+ * the very same results as the scalar code doing the same operations in the same order.
+ */
+namespace simd {
+
+#if defined(MATH_SIMD_AVX) || defined(MATH_SIMD_SSE2)
+static_assert(std::is_same<Real, double>::value, "SIMD packs are only implemented for double precision");
+#endif
+
+#if defined(MATH_SIMD_AVX)
+
+constexpr unsigned width = 4;
+struct Pack { __m256d v; };
+struct Mask { __m256d v; };
+
+inline Pack load(const Real* p) { return {_mm256_loadu_pd(p)}; }
+inline void store(Real* p, Pack a) { _mm256_storeu_pd(p, a.v); }
+inline Pack broadcast(Real x) { return {_mm256_set1_pd(x)}; }
+
+inline Pack operator+(Pack a, Pack b) { return {_mm256_add_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a, Pack b) { return {_mm256_sub_pd(a.v, b.v)}; }
+inline Pack operator*(Pack a, Pack b) { return {_mm256_mul_pd(a.v, b.v)}; }
+inline Pack operator/(Pack a, Pack b) { return {_mm256_div_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+inline Pack abs(Pack a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+inline Pack sqrt(Pack a) { return {_mm256_sqrt_pd(a.v)}; }
+
+inline Mask operator<(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator<=(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ)}; }
+inline Mask operator>(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+inline Mask operator>=(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ)}; }
+inline Mask operator==(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ)}; }
+inline Mask operator!=(Pack a, Pack b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_NEQ_UQ)}; }
+
+inline Mask operator&(Mask a, Mask b) { return {_mm256_and_pd(a.v, b.v)}; }
+inline Mask operator|(Mask a, Mask b) { return {_mm256_or_pd(a.v, b.v)}; }
+inline Mask operator!(Mask a) { return {_mm256_xor_pd(a.v, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))}; }
+
+/// Picks a where the mask is set and b elsewhere.
+inline Pack select(Mask mask, Pack a, Pack b) { return {_mm256_blendv_pd(b.v, a.v, mask.v)}; }
+
+/// One bit per lane, lane 0 being the lowest bit.
+inline unsigned bits(Mask mask) { return unsigned(_mm256_movemask_pd(mask.v)); }
+
+/// Builds a mask from one bit per lane, lane 0 being the lowest bit.
+inline Mask fromBits(unsigned b) {
+	return {_mm256_castsi256_pd(_mm256_set_epi64x(
+		b & 8 ? -1 : 0, b & 4 ? -1 : 0, b & 2 ? -1 : 0, b & 1 ? -1 : 0))};
+}
+
+#elif defined(MATH_SIMD_SSE2)
+
+constexpr unsigned width = 2;
+struct Pack { __m128d v; };
+struct Mask { __m128d v; };
+
+inline Pack load(const Real* p) { return {_mm_loadu_pd(p)}; }
+inline void store(Real* p, Pack a) { _mm_storeu_pd(p, a.v); }
+inline Pack broadcast(Real x) { return {_mm_set1_pd(x)}; }
+
+inline Pack operator+(Pack a, Pack b) { return {_mm_add_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a, Pack b) { return {_mm_sub_pd(a.v, b.v)}; }
+inline Pack operator*(Pack a, Pack b) { return {_mm_mul_pd(a.v, b.v)}; }
+inline Pack operator/(Pack a, Pack b) { return {_mm_div_pd(a.v, b.v)}; }
+inline Pack operator-(Pack a) { return {_mm_xor_pd(a.v, _mm_set1_pd(-0.0))}; }
+inline Pack abs(Pack a) { return {_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)}; }
+inline Pack sqrt(Pack a) { return {_mm_sqrt_pd(a.v)}; }
+
+inline Mask operator<(Pack a, Pack b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+inline Mask operator<=(Pack a, Pack b) { return {_mm_cmple_pd(a.v, b.v)}; }
+inline Mask operator>(Pack a, Pack b) { return {_mm_cmpgt_pd(a.v, b.v)}; }
+inline Mask operator>=(Pack a, Pack b) { return {_mm_cmpge_pd(a.v, b.v)}; }
+inline Mask operator==(Pack a, Pack b) { return {_mm_cmpeq_pd(a.v, b.v)}; }
+inline Mask operator!=(Pack a, Pack b) { return {_mm_cmpneq_pd(a.v, b.v)}; }
+
+inline Mask operator&(Mask a, Mask b) { return {_mm_and_pd(a.v, b.v)}; }
+inline Mask operator|(Mask a, Mask b) { return {_mm_or_pd(a.v, b.v)}; }
+inline Mask operator!(Mask a) { return {_mm_xor_pd(a.v, _mm_castsi128_pd(_mm_set1_epi32(-1)))}; }
+
+/// Picks a where the mask is set and b elsewhere.
+inline Pack select(Mask mask, Pack a, Pack b) { return {_mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v))}; }
+
+/// One bit per lane, lane 0 being the lowest bit.
+inline unsigned bits(Mask mask) { return unsigned(_mm_movemask_pd(mask.v)); }
+
+/// Builds a mask from one bit per lane, lane 0 being the lowest bit.
+inline Mask fromBits(unsigned b) {
+	return {_mm_castsi128_pd(_mm_set_epi64x(b & 2 ? -1 : 0, b & 1 ? -1 : 0))};
+}
+
+#else
+
+constexpr unsigned width = 1;
+struct Pack { Real v; };
+struct Mask { bool v; };
+
+inline Pack load(const Real* p) { return {*p}; }
+inline void store(Real* p, Pack a) { *p = a.v; }
+inline Pack broadcast(Real x) { return {x}; }
+
+inline Pack operator+(Pack a, Pack b) { return {a.v + b.v}; }
+inline Pack operator-(Pack a, Pack b) { return {a.v - b.v}; }
+inline Pack operator*(Pack a, Pack b) { return {a.v * b.v}; }
+inline Pack operator/(Pack a, Pack b) { return {a.v / b.v}; }
+inline Pack operator-(Pack a) { return {-a.v}; }
+inline Pack abs(Pack a) { return {std::abs(a.v)}; }
+inline Pack sqrt(Pack a) { return {std::sqrt(a.v)}; }
+
+inline Mask operator<(Pack a, Pack b) { return {a.v < b.v}; }
+inline Mask operator<=(Pack a, Pack b) { return {a.v <= b.v}; }
+inline Mask operator>(Pack a, Pack b) { return {a.v > b.v}; }
+inline Mask operator>=(Pack a, Pack b) { return {a.v >= b.v}; }
+inline Mask operator==(Pack a, Pack b) { return {a.v == b.v}; }
+inline Mask operator!=(Pack a, Pack b) { return {a.v != b.v}; }
+
+inline Mask operator&(Mask a, Mask b) { return {a.v && b.v}; }
+inline Mask operator|(Mask a, Mask b) { return {a.v || b.v}; }
+inline Mask operator!(Mask a) { return {!a.v}; }
+
+/// Picks a where the mask is set and b elsewhere.
+inline Pack select(Mask mask, Pack a, Pack b) { return mask.v ? a : b; }
+
+/// One bit per lane, lane 0 being the lowest bit.
+inline unsigned bits(Mask mask) { return mask.v ? 1 : 0; }
+
+/// Builds a mask from one bit per lane, lane 0 being the lowest bit.
+inline Mask fromBits(unsigned b) { return {(b & 1) != 0}; }
+
+#endif
+
+/// The mask with every lane set.
+constexpr unsigned allBits = (1u << width) - 1;
+
+} // namespace simd
+} // namespace math
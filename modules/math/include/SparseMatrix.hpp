@@ -0,0 +1,79 @@
+#pragma once
+
+#include <math/Real>
+#include <math/ThreadPool>
+#include <cstddef>
+#include <vector>
+
+namespace math {
+
+/*!
+ * \brief The SparseMatrix class is a matrix that only stores its non-zero cells, in compressed sparse rows.
+ *
+ * The cells of each row are stored contiguously by increasing column, after those of the previous rows, so a product
+ * by a vector reads the matrix once, in order, and each row is computed independently of the others. That makes
+ * multiply() easy to split between threads, with the same results whatever their number.
+ *
+ * The matrix is built at once from a list of cells, in any order, and then only its values can change.
+ */
+class SparseMatrix {
+public:
+
+	/// A cell of the matrix, for building it.
+	struct Entry {
+		std::size_t row;
+		std::size_t col;
+		Real value;
+	};
+
+	/// A matrix of no rows and no columns.
+	SparseMatrix();
+
+	/// \brief A matrix holding entries, and zeros elsewhere. Complexity: O(n log n), n entries
+	///
+	/// Entries on the same cell are added. Throws if an entry is out of the matrix.
+	SparseMatrix(std::size_t rows, std::size_t cols, std::vector<Entry> entries);
+
+	std::size_t rows() const;
+	std::size_t cols() const;
+
+	/// The number of stored cells.
+	std::size_t nonZeros() const;
+
+	/// The cell (i, j), zero if it is not stored. Complexity: O(log k), k cells stored in the row
+	Real operator()(std::size_t i, std::size_t j) const;
+
+	/// The stored cell (i, j). Throws if it is not stored, since the structure can't change.
+	Real& at(std::size_t i, std::size_t j);
+
+	/// The cells of the diagonal.
+	std::vector<Real> diagonal() const;
+
+	/// Matrix vector product.
+	std::vector<Real> operator*(const std::vector<Real>& vec) const;
+
+	/// \brief Computes the product by vec into result, which is resized and must not be vec. Complexity: O(nonZeros)
+	///
+	/// When a pool is given, the rows are split between its threads.
+	void multiply(const std::vector<Real>& vec, std::vector<Real>& result, ThreadPool* pool = nullptr) const;
+
+	/// The first stored cell of each row, and the end of the last row, rows() + 1 items.
+	const std::vector<std::size_t>& rowStarts() const;
+
+	/// The column of each stored cell.
+	const std::vector<std::size_t>& columns() const;
+
+	/// The value of each stored cell.
+	const std::vector<Real>& values() const;
+
+private:
+
+	std::size_t _rows;
+	std::size_t _cols;
+	std::vector<std::size_t> _rowStarts;
+	std::vector<std::size_t> _columns;
+	std::vector<Real> _values;
+
+};
+
+} // namespace math
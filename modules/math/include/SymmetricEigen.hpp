@@ -0,0 +1,192 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/Simd>
+#include <math/ThreadPool>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+
+namespace math {
+
+namespace internal {
+	/// \brief Cyclic Jacobi on simd::width symmetric 3x3 matrices at once, one per lane.
+	///
+	/// Each rotation zeroes an off-diagonal cell of a, and is accumulated into the columns of v, which must start as
+	/// the identity. Rotations are computed without branches, so every lane runs the same instructions. On return the
+	/// diagonal of a holds the eigenvalues in decreasing order, and the columns of v the matching eigenvectors, with
+	/// the last column the cross product of the other two.
+	inline void jacobi3(simd::Pack a[3][3], simd::Pack v[3][3]) {
+		const simd::Pack zero = simd::broadcast(0);
+		const simd::Pack one = simd::broadcast(1);
+		const Real epsilon = std::numeric_limits<Real>::epsilon();
+		const simd::Pack tolerance = simd::broadcast(epsilon * epsilon);
+		const unsigned pairs[3][2] = {{0, 1}, {0, 2}, {1, 2}};
+
+		// Each sweep squares the off-diagonal error, so a handful is enough even from a bad start
+		for (unsigned sweep = 0; sweep < 16; ++sweep) {
+			simd::Pack off = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+			simd::Pack diagonal = a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+			if (simd::bits(!(off <= tolerance * diagonal)) == 0) break;
+
+			for (const auto& pair : pairs) {
+				unsigned p = pair[0], q = pair[1], r = 3 - p - q;
+				simd::Pack apq = a[p][q];
+
+				// The smaller root of t² + 2 theta t - 1 = 0, the tangent of the rotation angle. A null cell gives
+				// t = 0, and a theta too large to square gives t = 0 through infinity
+				simd::Pack theta = (a[q][q] - a[p][p]) / (apq + apq);
+				simd::Pack sign = simd::select(theta < zero, -one, one);
+				simd::Pack t = sign / (simd::abs(theta) + simd::sqrt(theta*theta + one));
+				t = simd::select(apq == zero, zero, t);
+				simd::Pack c = one / simd::sqrt(t*t + one);
+				simd::Pack s = t * c;
+
+				simd::Pack arp = a[r][p], arq = a[r][q];
+				a[p][p] = a[p][p] - t * apq;
+				a[q][q] = a[q][q] + t * apq;
+				a[p][q] = a[q][p] = zero;
+				a[r][p] = a[p][r] = c * arp - s * arq;
+				a[r][q] = a[q][r] = s * arp + c * arq;
+
+				for (unsigned k = 0; k < 3; ++k) {
+					simd::Pack vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+
+		// Sorts the eigenvalues with their columns, by three compare and swaps
+		const unsigned swaps[3][2] = {{0, 1}, {1, 2}, {0, 1}};
+		for (const auto& swap : swaps) {
+			unsigned i = swap[0], j = swap[1];
+			simd::Mask out = a[i][i] < a[j][j];
+			simd::Pack ai = a[i][i];
+			a[i][i] = simd::select(out, a[j][j], ai);
+			a[j][j] = simd::select(out, ai, a[j][j]);
+			for (unsigned k = 0; k < 3; ++k) {
+				simd::Pack vki = v[k][i];
+				v[k][i] = simd::select(out, v[k][j], vki);
+				v[k][j] = simd::select(out, vki, v[k][j]);
+			}
+		}
+
+		// A right-handed basis, so that the eigenvectors are a rotation
+		v[0][2] = v[1][0]*v[2][1] - v[2][0]*v[1][1];
+		v[1][2] = v[2][0]*v[0][1] - v[0][0]*v[2][1];
+		v[2][2] = v[0][0]*v[1][1] - v[1][0]*v[0][1];
+	}
+
+	/// \brief Runs kernel over count items, simd::width at a time, optionally split between the threads of a pool.
+	///
+	/// kernel(first, lanes) handles items [first, first + lanes), lanes being simd::width except at the end.
+	template <typename Kernel>
+	inline void forLanes(std::size_t count, ThreadPool* pool, const Kernel& kernel) {
+		const std::size_t grain = 64;
+		std::size_t registers = (count + simd::width - 1) / simd::width;
+		auto body = [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i) {
+				std::size_t first = i * simd::width;
+				kernel(first, unsigned(std::min<std::size_t>(simd::width, count - first)));
+			}
+		};
+		if (pool && registers > grain) pool->parallelFor(registers, grain, body);
+		else body(0, registers);
+	}
+
+	/// Loads cell (i, j) of lanes matrices into a pack. Missing lanes get the cell of the identity
+	inline simd::Pack gather(const Matrix3* matrices, unsigned lanes, unsigned i, unsigned j) {
+		Real cells[simd::width];
+		for (unsigned l = 0; l < simd::width; ++l)
+			cells[l] = l < lanes ? matrices[l](i, j) : Real(i == j);
+		return simd::load(cells);
+	}
+
+	/// Stores the lanes of a pack into cell (i, j) of lanes matrices
+	inline void scatter(simd::Pack pack, Matrix3* matrices, unsigned lanes, unsigned i, unsigned j) {
+		Real cells[simd::width];
+		simd::store(cells, pack);
+		for (unsigned l = 0; l < lanes; ++l)
+			matrices[l](i, j) = cells[l];
+	}
+
+	/// Stores the lanes of a pack into component c of lanes vectors
+	inline void scatter(simd::Pack pack, Vector3* vectors, unsigned lanes, unsigned c) {
+		Real cells[simd::width];
+		simd::store(cells, pack);
+		for (unsigned l = 0; l < lanes; ++l)
+			vectors[l](c) = cells[l];
+	}
+}
+
+/*!
+ * \brief The SymmetricEigen3 class is the decomposition A = V * D * V^T of a symmetric 3x3 matrix.
+ *
+ * D is diagonal, holding the eigenvalues, and the columns of V are the eigenvectors, such as the principal axes of an
+ * inertia tensor or of a covariance matrix. It is computed by cyclic Jacobi rotations, which give eigenvalues to
+ * within a few units in the last place of the largest one, and orthonormal eigenvectors even for repeated eigenvalues.
+ *
+ * The rotations have no branches, so decompose() runs simd::width matrices per instruction, one per lane.
+ */
+class SymmetricEigen3 {
+public:
+
+	/// Decomposes mat. Only its upper triangle is read.
+	explicit SymmetricEigen3(const Matrix3& mat);
+
+	/// The eigenvalues, in decreasing order.
+	const Vector3& values() const;
+
+	/// The eigenvectors, as the columns of a rotation matrix, in the order of values().
+	const Matrix3& vectors() const;
+
+	/// \brief Decomposes count matrices, writing count items to values and vectors.
+	///
+	/// When a pool is given, the matrices are split between its threads.
+	static void decompose(const Matrix3* matrices, std::size_t count, Vector3* values, Matrix3* vectors,
+	                      ThreadPool* pool = nullptr);
+
+private:
+
+	Vector3 _values;
+	Matrix3 _vectors;
+
+};
+
+inline SymmetricEigen3::SymmetricEigen3(const Matrix3& mat) {
+	decompose(&mat, 1, &_values, &_vectors);
+}
+
+inline const Vector3& SymmetricEigen3::values() const {
+	return _values;
+}
+
+inline const Matrix3& SymmetricEigen3::vectors() const {
+	return _vectors;
+}
+
+inline void SymmetricEigen3::decompose(const Matrix3* matrices, std::size_t count, Vector3* values, Matrix3* vectors,
+                                       ThreadPool* pool) {
+	internal::forLanes(count, pool, [&](std::size_t first, unsigned lanes) {
+		simd::Pack a[3][3], v[3][3];
+		for (unsigned i = 0; i < 3; ++i) {
+			for (unsigned j = i; j < 3; ++j)
+				a[i][j] = a[j][i] = internal::gather(matrices + first, lanes, i, j);
+			for (unsigned j = 0; j < 3; ++j)
+				v[i][j] = simd::broadcast(Real(i == j));
+		}
+
+		internal::jacobi3(a, v);
+
+		for (unsigned i = 0; i < 3; ++i) {
+			internal::scatter(a[i][i], values + first, lanes, i);
+			for (unsigned j = 0; j < 3; ++j)
+				internal::scatter(v[i][j], vectors + first, lanes, i, j);
+		}
+	});
+}
+
+}  // math namespace
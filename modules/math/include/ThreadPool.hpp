@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace math {
+
+/*!
+ * \brief The ThreadPool class keeps a set of threads around to split loops between them.
+ *
+ * The threads are started once and sleep between loops, so a loop costs no thread creation. The thread calling
+ * parallelFor() works on the loop too, so a pool of size n starts n-1 threads.
+ *
+ * Work is handed out in chunks, in no particular order. A loop body that only writes to the elements of its own
+ * chunk gives the same results whatever the number of threads.
+ */
+class ThreadPool {
+public:
+
+	/// The body of a loop, called with the range [begin, end) of a chunk.
+	using Body = std::function<void(std::size_t begin, std::size_t end)>;
+
+	/// Starts the threads. When threads is zero, all hardware threads are used.
+	explicit ThreadPool(unsigned threads = 0);
+
+	/// Waits for the running loop, if any, and stops the threads.
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// Returns the number of threads working on each loop, counting the caller.
+	unsigned size() const;
+
+	/// \brief Runs body over [0, count), in chunks of grain elements, and waits for all of them.
+	///
+	/// Loops from different threads run one after the other. A body must not start a loop on the same pool.
+	/// If a body throws, the remaining chunks are skipped and the first exception is thrown here.
+	void parallelFor(std::size_t count, std::size_t grain, const Body& body);
+
+private:
+
+	void work();
+	void runChunks();
+
+	std::vector<std::thread> _workers;
+
+	std::mutex _loop;                 //!< Held while a loop runs, so loops don't overlap.
+	std::mutex _mutex;                //!< Guards the fields below.
+	std::condition_variable _wake;    //!< Signals a new loop, or the end of the pool.
+	std::condition_variable _done;    //!< Signals that the last worker finished the loop.
+	unsigned long _generation;        //!< Counts loops, so workers notice a new one.
+	unsigned _busy;                   //!< Workers that didn't finish the current loop yet.
+	bool _stopping;
+
+	const Body* _body;
+	std::size_t _count;
+	std::size_t _grain;
+	std::atomic<std::size_t> _next;   //!< The first element of the next chunk to hand out.
+	std::atomic<bool> _failed;
+	std::exception_ptr _error;
+
+};
+
+} // namespace math
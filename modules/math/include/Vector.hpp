@@ -1,93 +1,298 @@
 #pragma once
 
 #include <math/Real>
+#include <math/Simd>
+#include <math/Functions>
 #include <cmath>
 #include <stdexcept>
 #include <array>
 #include <algorithm>
+#include <type_traits>
 
 namespace math {
 
-template <unsigned D>
-class Vector {
+template <unsigned D, typename T = Real>
+class Vector;
+
+namespace internal {
+	/// \brief How Vector<D, T> stores its components.
+	///
+	/// Vector3 is padded with a zero to 4 components, so Vector3 and Vector4 fill whole SIMD registers and run on
+	/// SimdKernels. Defining MATH_COMPACT_VECTOR3 keeps Vector3 at 3 components, on the scalar path, and defining
+	/// MATH_NO_SIMD does so for every size. SIMD packs hold Real, so vectors of other scalar types are never padded.
+	template <unsigned D, typename T>
+	struct VectorLayout {
+		static constexpr unsigned size = D;
+		static constexpr bool simd = false;
+	};
+	
+#if !defined(MATH_NO_SIMD) && !defined(MATH_COMPACT_VECTOR3)
+	template <>
+	struct VectorLayout<3, Real> {
+		static constexpr unsigned size = 4;
+		static constexpr bool simd = true;
+	};
+#endif
+	
+#if !defined(MATH_NO_SIMD)
+	template <>
+	struct VectorLayout<4, Real> {
+		static constexpr unsigned size = 4;
+		static constexpr bool simd = true;
+	};
+#endif
+	
+	/// The components of a Vector. 16 bytes is the most new is sure to align to, so packs are loaded unaligned.
+	template <unsigned S, bool Aligned, typename T>
+	struct alignas(Aligned ? 16 : alignof(T)) VectorStorage {
+		T v[S];
+		
+		constexpr const T& operator[](unsigned i) const { return v[i]; }
+		constexpr T& operator[](unsigned i) { return v[i]; }
+	};
+	
+	/// Reductions on S components, one at a time. These also run during constant evaluation.
+	template <unsigned S, typename T = Real>
+	struct ScalarKernels {
+		static constexpr T dot(const T* a, const T* b) {
+			T result = 0;
+			for (unsigned i = 0; i < S; ++i)
+				result += a[i] * b[i];
+			return result;
+		}
+	};
+	
+	/// The same reductions on SIMD packs, for 4 components.
+	template <unsigned S>
+	struct SimdKernels {
+		static_assert(S == 4 && S % simd::width == 0, "SIMD kernels work on 4 components");
+		
+		static Real dot(const Real* a, const Real* b) {
+			Real products[S];
+			for (unsigned p = 0; p < S; p += simd::width)
+				simd::store(products + p, simd::load(a + p) * simd::load(b + p));
+			
+			// Summed in pairs. With a zero in the padding, Vector3 sums in the same order as ScalarKernels
+			return (products[0] + products[1]) + (products[2] + products[3]);
+		}
+	};
+	
+	/// Element-wise operations of Vector and Matrix expressions, on scalars and on SIMD packs
+	struct Add {
+		template <typename T>
+		static constexpr T apply(T a, T b) { return a + b; }
+		static simd::Pack apply(simd::Pack a, simd::Pack b) { return a + b; }
+	};
+	
+	struct Subtract {
+		template <typename T>
+		static constexpr T apply(T a, T b) { return a - b; }
+		static simd::Pack apply(simd::Pack a, simd::Pack b) { return a - b; }
+	};
+	
+	struct Multiply {
+		template <typename T>
+		static constexpr T apply(T a, T b) { return a * b; }
+		static simd::Pack apply(simd::Pack a, simd::Pack b) { return a * b; }
+	};
+	
+	struct Divide {
+		template <typename T>
+		static constexpr T apply(T a, T b) { return a / b; }
+		static simd::Pack apply(simd::Pack a, simd::Pack b) { return a / b; }
+	};
+	
+	/// Discards the value it replaces, so that assignment runs through the same loops as compound operators
+	struct Replace {
+		template <typename T>
+		static constexpr T apply(T, T b) { return b; }
+		static simd::Pack apply(simd::Pack, simd::Pack b) { return b; }
+	};
+	
+	/// Keeps scalars out of template argument deduction, so that vec * 2 works whatever the type of vec
+	template <typename T>
+	struct Identity {
+		using type = T;
+	};
+	
+	template <typename T>
+	using NonDeduced = typename Identity<T>::type;
+	
+	/// How an expression holds an operand: vectors by reference, and expressions, which are small, by value
+	template <typename E>
+	struct VectorOperand {
+		using type = E;
+	};
+	
+	template <unsigned D, typename T>
+	struct VectorOperand<Vector<D, T>> {
+		using type = const Vector<D, T>&;
+	};
+	
+	template <unsigned D, typename T, typename Op, typename L, typename R>
+	class VectorBinary;
+	
+	template <unsigned D, typename T>
+	class VectorBroadcast;
+	
+	/// Whether every type converts to Real, so that the arguments are components rather than vectors
+	template <typename... Types>
+	struct AllReal : std::true_type {};
+	
+	template <typename Head, typename... Tail>
+	struct AllReal<Head, Tail...> : std::integral_constant<bool, std::is_convertible<Head, Real>::value && AllReal<Tail...>::value> {};
+} // internal
+
+/*!
+ * \brief The VectorExpression class is the base of vectors and of the arithmetic between them.
+ *
+ * Arithmetic on vectors does not compute anything: it returns a small object describing the operation, such as
+ * internal::VectorBinary. The whole expression is computed in a single loop, with no temporary vector, when it is
+ * assigned to a Vector. The members that are not element-wise compute the expression first.
+ */
+template <unsigned D, typename T, typename E>
+class VectorExpression {
+public:
+
+	constexpr const E& derived() const { return static_cast<const E&>(*this); }
+
+	/// Computes the expression
+	constexpr Vector<D, T> eval() const { return Vector<D, T>(derived()); }
+
+	constexpr T operator()(unsigned i) const;
+
+	constexpr T x() const;
+	constexpr T y() const;
+	constexpr T z() const;
+	constexpr T t() const;
+
+	constexpr bool isNan() const { return eval().isNan(); }
+	constexpr T dot(const Vector<D, T>& vec) const { return eval().dot(vec); }
+	constexpr T dotself() const { return eval().dotself(); }
+	constexpr T length() const { return eval().length(); }
+	constexpr Vector<D, T> cross(const Vector<D, T>& vec) const { return eval().cross(vec); }
+	constexpr Vector<D, T> unit() const { return eval().unit(); }
+
+	template <unsigned F>
+	constexpr Vector<F, T> subvector() const { return eval().template subvector<F>(); }
+
+	constexpr bool operator>(const Vector<D, T>& vec) const { return eval() > vec; }
+	constexpr bool operator<(const Vector<D, T>& vec) const { return eval() < vec; }
+	constexpr bool operator>=(const Vector<D, T>& vec) const { return eval() >= vec; }
+	constexpr bool operator<=(const Vector<D, T>& vec) const { return eval() <= vec; }
+	constexpr bool operator==(const Vector<D, T>& vec) const { return eval() == vec; }
+
+};
+
+template <unsigned D, typename T>
+class Vector : public VectorExpression<D, T, Vector<D, T>> {
 	static_assert(D > 0, "Can't make a vector with no dimentions");
 public:
 
 	constexpr Vector();
 
-	constexpr Vector(const Vector<D>& other);
-	constexpr Vector(Vector<D>& other);
+	constexpr Vector(const Vector<D, T>& other);
+	constexpr Vector(Vector<D, T>& other);
 
-	template <typename... Args>
+	template <typename... Args, typename = typename std::enable_if<internal::AllReal<Args...>::value>::type>
 	constexpr Vector(const Args&... args);
 
-	template <unsigned E, typename... Args>
-	constexpr Vector(const Vector<E>& vec, Args&&... args);
+	/// Computes an expression
+	template <typename E>
+	constexpr Vector(const VectorExpression<D, T, E>& expr);
+
+	/// Converts a vector of another scalar type
+	template <typename U>
+	explicit constexpr Vector(const Vector<D, U>& other);
+
+	/// Extends a smaller vector with more components
+	template <unsigned E, typename Expr, typename Arg, typename... Args>
+	constexpr Vector(const VectorExpression<E, T, Expr>& vec, Arg&& arg, Args&&... args);
+
+	template <typename E>
+	constexpr Vector<D, T>& operator=(const VectorExpression<D, T, E>& expr);
+
+	constexpr const Vector<D, T>& eval() const;
 
 	constexpr bool isNan() const;
 
-	constexpr Real x() const;
-	constexpr Real y() const;
-	constexpr Real z() const;
-	constexpr Real t() const;
-	constexpr const Real& operator()(unsigned i) const;
-	constexpr Real& operator()(unsigned i);
+	constexpr T x() const;
+	constexpr T y() const;
+	constexpr T z() const;
+	constexpr T t() const;
+	constexpr const T& operator()(unsigned i) const;
+	constexpr T& operator()(unsigned i);
 
-	constexpr Vector operator+(const Vector<D>& vec) const;
-	constexpr Vector operator-(const Vector<D>& vec) const;
-	
-	constexpr Vector operator+() const;
-	constexpr Vector operator-() const;
-	
-	constexpr Vector operator*(const Real& real) const;
-	constexpr Vector operator/(const Real& real) const;
-	
 	/// Component-wise multiplication between vectors
-	constexpr Vector operator*(const Vector<D>& vec) const;
+	template <typename E>
+	constexpr Vector<D, T>& operator*=(const VectorExpression<D, T, E>& vec);
 	
 	/// Component-wise division between vectors
-	constexpr Vector operator/(const Vector<D>& vec) const;
+	template <typename E>
+	constexpr Vector<D, T>& operator/=(const VectorExpression<D, T, E>& vec);
 	
-	/// Component-wise multiplication between vectors
-	constexpr Vector<D>& operator*=(const Vector<D>& vec);
+	template <typename E>
+	constexpr Vector<D, T>& operator+=(const VectorExpression<D, T, E>& vec);
+	template <typename E>
+	constexpr Vector<D, T>& operator-=(const VectorExpression<D, T, E>& vec);
+	constexpr Vector<D, T>& operator*=(const T& real);
+	constexpr Vector<D, T>& operator/=(const T& real);
 	
-	/// Component-wise division between vectors
-	constexpr Vector<D>& operator/=(const Vector<D>& vec);
-	
-	constexpr Vector<D>& operator+=(const Vector<D>& vec);
-	constexpr Vector<D>& operator-=(const Vector<D>& vec);
-	constexpr Vector<D>& operator*=(const Real& real);
-	constexpr Vector<D>& operator/=(const Real& real);
-	
-	constexpr bool operator>(const Vector<D>& vec) const;
-	constexpr bool operator<(const Vector<D>& vec) const;
-	constexpr bool operator>=(const Vector<D>& vec) const;
-	constexpr bool operator<=(const Vector<D>& vec) const;
-	constexpr bool operator==(const Vector<D>& vec) const;
+	constexpr bool operator>(const Vector<D, T>& vec) const;
+	constexpr bool operator<(const Vector<D, T>& vec) const;
+	constexpr bool operator>=(const Vector<D, T>& vec) const;
+	constexpr bool operator<=(const Vector<D, T>& vec) const;
+	constexpr bool operator==(const Vector<D, T>& vec) const;
 	
 	/// The dot product of a vector with another vector
-	constexpr Real dot(const Vector<D>& vec) const;
+	constexpr T dot(const Vector<D, T>& vec) const;
 	
 	/// Returns the dot product of a vector with itself
-	constexpr Real dotself() const;
+	constexpr T dotself() const;
 	
 	/// Returns the length of a vector
-	Real length() const; // requires sqrt which is not constexpr. How fix?
+	constexpr T length() const;
 	
 	/// Returns the cross product of a vector
-	constexpr Vector cross(const Vector<D>& vec) const;
+	constexpr Vector cross(const Vector<D, T>& vec) const;
 	
 	/// Returns the unit vector
 	constexpr Vector unit() const;
 
 	template <unsigned E>
-	constexpr Vector<E> subvector() const;
+	constexpr Vector<E, T> subvector() const;
 	
 	void swapline(unsigned a, unsigned b);
 
 private:
 
-	std::array<Real, D> _v;
+	template <unsigned, typename, typename, typename, typename> friend class internal::VectorBinary;
+	template <unsigned, typename, typename> friend class VectorExpression;
+
+	using Layout = internal::VectorLayout<D, T>;
+	using Kernels = typename std::conditional<Layout::simd, internal::SimdKernels<Layout::size>, internal::ScalarKernels<Layout::size, T>>::type;
+	
+	/// Whether to run on Kernels rather than on scalars
+	static constexpr bool simd() { return Layout::simd && !MATH_IS_CONSTANT_EVALUATED(); }
+	
+	/// Sets the padding back to zero, after operations that may have changed it
+	constexpr void clearPadding();
+	
+	/// Component i, or padding, as an expression operand
+	constexpr T element(unsigned i) const { return _v[i]; }
+	simd::Pack pack(unsigned p) const { return simd::load(_v.v + p); }
+	
+	/// Replaces each component c by Op::apply(c, e), where e is the same component of an expression
+	template <typename Op, typename E>
+	constexpr Vector<D, T>& update(const E& expr);
+	
+	/// The same on scalars, and on SIMD packs when the layout allows them
+	template <typename Op, typename E>
+	constexpr Vector<D, T>& update(const E& expr, std::false_type);
+	template <typename Op, typename E>
+	constexpr Vector<D, T>& update(const E& expr, std::true_type);
+
+	internal::VectorStorage<Layout::size, Layout::simd, T> _v;
 
 };
 
@@ -95,76 +300,216 @@ using Vector2 = Vector<2>;
 using Vector3 = Vector<3>;
 using Vector4 = Vector<4>;
 
-template <unsigned D>
-inline constexpr Vector<D>::Vector() {
-	for (unsigned i = 0; i < D; ++i)
-		_v[i] = 0;
+template <unsigned D, typename T>
+inline constexpr Vector<D, T>::Vector() : _v{} {
+
 }
 
-template <unsigned D>
-inline constexpr Vector<D>::Vector(const Vector<D>& other) : _v(other._v) {
+template <unsigned D, typename T>
+inline constexpr Vector<D, T>::Vector(const Vector<D, T>& other) : _v(other._v) {
 
 }
 
-template <unsigned D>
-inline constexpr Vector<D>::Vector(Vector<D>& other) : _v(other._v) {
+template <unsigned D, typename T>
+inline constexpr Vector<D, T>::Vector(Vector<D, T>& other) : _v(other._v) {
 
 }
 
-template <unsigned D>
-template <typename... Args>
-inline constexpr Vector<D>::Vector(const Args&... args) : _v{{Real(args)...}}
+template <unsigned D, typename T>
+template <typename... Args, typename>
+inline constexpr Vector<D, T>::Vector(const Args&... args) : _v{{T(args)...}}
 {
 	static_assert(sizeof...(Args) == D, "Invalid number of constructor arguments");
 }
 
-template <unsigned D>
-template <unsigned E, typename... Args>
-inline constexpr Vector<D>::Vector(const Vector<E>& vec, Args&&... args) : _v{}
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>::Vector(const VectorExpression<D, T, E>& expr) : _v{}
+{
+	update<internal::Replace>(expr.derived());
+}
+
+template <unsigned D, typename T>
+template <typename U>
+inline constexpr Vector<D, T>::Vector(const Vector<D, U>& other) : _v{}
+{
+	for (unsigned i = 0; i < D; ++i)
+		_v[i] = T(other(i));
+}
+
+template <unsigned D, typename T>
+template <unsigned E, typename Expr, typename Arg, typename... Args>
+inline constexpr Vector<D, T>::Vector(const VectorExpression<E, T, Expr>& vec, Arg&& arg, Args&&... args) : _v{}
 {
-	static_assert(sizeof...(Args) == D-E, "Invalid number of constructor arguments");
-	Real pack[] = {Real(args)...};
+	static_assert(sizeof...(Args) + 1 == D-E, "Invalid number of constructor arguments");
+	T pack[] = {T(arg), T(args)...};
 
 	for (unsigned i = 0; i < E; ++i)
 		_v[i] = vec(i);
 
 	for (unsigned i = E; i < D; ++i)
-		_v[i] = pack[E-i];
+		_v[i] = pack[i-E];
+}
+
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::operator=(const VectorExpression<D, T, E>& expr) {
+	update<internal::Replace>(expr.derived());
+	return *this;
+}
+
+template <unsigned D, typename T>
+inline constexpr const Vector<D, T>& Vector<D, T>::eval() const {
+	return *this;
+}
+
+namespace internal {
+	/// An element-wise operation between two vector expressions
+	template <unsigned D, typename T, typename Op, typename L, typename R>
+	class VectorBinary : public VectorExpression<D, T, VectorBinary<D, T, Op, L, R>> {
+	public:
+		constexpr VectorBinary(const L& l, const R& r) : _l(l), _r(r) {}
+		
+		constexpr T element(unsigned i) const { return Op::apply(_l.element(i), _r.element(i)); }
+		simd::Pack pack(unsigned p) const { return Op::apply(_l.pack(p), _r.pack(p)); }
+		
+	private:
+		typename VectorOperand<L>::type _l;
+		typename VectorOperand<R>::type _r;
+	};
+	
+	/// A scalar, as a vector with the same value in every component
+	template <unsigned D, typename T>
+	class VectorBroadcast : public VectorExpression<D, T, VectorBroadcast<D, T>> {
+	public:
+		constexpr explicit VectorBroadcast(T real) : _real(real) {}
+		
+		constexpr T element(unsigned) const { return _real; }
+		simd::Pack pack(unsigned) const { return simd::broadcast(_real); }
+		
+	private:
+		T _real;
+	};
+} // internal
+
+template <unsigned D, typename T, typename E>
+inline constexpr T VectorExpression<D, T, E>::operator()(unsigned i) const {
+#ifdef DEBUG
+	if (i >= D)
+		throw std::logic_error("Invalid index");
+#endif
+
+	return derived().element(i);
 }
 
-template <unsigned D>
-constexpr Vector<D> operator*(const Real& real, const Vector<D>& vec) {
+template <unsigned D, typename T, typename E>
+inline constexpr T VectorExpression<D, T, E>::x() const {
+	static_assert(D >= 1, "Invalid number of dimentions for x component");
+	return derived().element(0);
+}
+
+template <unsigned D, typename T, typename E>
+inline constexpr T VectorExpression<D, T, E>::y() const {
+	static_assert(D >= 2, "Invalid number of dimentions for y component");
+	return derived().element(1);
+}
+
+template <unsigned D, typename T, typename E>
+inline constexpr T VectorExpression<D, T, E>::z() const {
+	static_assert(D >= 3, "Invalid number of dimentions for z component");
+	return derived().element(2);
+}
+
+template <unsigned D, typename T, typename E>
+inline constexpr T VectorExpression<D, T, E>::t() const {
+	static_assert(D >= 4, "Invalid number of dimentions for t component");
+	return derived().element(3);
+}
+
+template <unsigned D, typename T, typename L, typename R>
+constexpr internal::VectorBinary<D, T, internal::Add, L, R> operator+(const VectorExpression<D, T, L>& a, const VectorExpression<D, T, R>& b) {
+	return {a.derived(), b.derived()};
+}
+
+template <unsigned D, typename T, typename L, typename R>
+constexpr internal::VectorBinary<D, T, internal::Subtract, L, R> operator-(const VectorExpression<D, T, L>& a, const VectorExpression<D, T, R>& b) {
+	return {a.derived(), b.derived()};
+}
+
+/// Component-wise multiplication between vectors
+template <unsigned D, typename T, typename L, typename R>
+constexpr internal::VectorBinary<D, T, internal::Multiply, L, R> operator*(const VectorExpression<D, T, L>& a, const VectorExpression<D, T, R>& b) {
+	return {a.derived(), b.derived()};
+}
+
+/// Component-wise division between vectors
+template <unsigned D, typename T, typename L, typename R>
+constexpr internal::VectorBinary<D, T, internal::Divide, L, R> operator/(const VectorExpression<D, T, L>& a, const VectorExpression<D, T, R>& b) {
+#ifdef DEBUG
+	for (unsigned i = 0; i < D; ++i)
+		if (b(i) == 0)
+			throw std::logic_error("Can't divide by zero");
+#endif
+
+	return {a.derived(), b.derived()};
+}
+
+template <unsigned D, typename T, typename E>
+constexpr internal::VectorBinary<D, T, internal::Multiply, E, internal::VectorBroadcast<D, T>> operator*(const VectorExpression<D, T, E>& vec, const internal::NonDeduced<T>& real) {
+	return {vec.derived(), internal::VectorBroadcast<D, T>(real)};
+}
+
+template <unsigned D, typename T, typename E>
+constexpr internal::VectorBinary<D, T, internal::Multiply, E, internal::VectorBroadcast<D, T>> operator*(const internal::NonDeduced<T>& real, const VectorExpression<D, T, E>& vec) {
 	return vec * real;
 }
 
-template <unsigned D>
-inline constexpr bool Vector<D>::isNan() const {
+template <unsigned D, typename T, typename E>
+constexpr internal::VectorBinary<D, T, internal::Divide, E, internal::VectorBroadcast<D, T>> operator/(const VectorExpression<D, T, E>& vec, const internal::NonDeduced<T>& real) {
+#ifdef DEBUG
+	if (real == 0)
+		throw std::logic_error("Can't divide by zero");
+#endif
+
+	return {vec.derived(), internal::VectorBroadcast<D, T>(real)};
+}
+
+template <unsigned D, typename T, typename E>
+constexpr E operator+(const VectorExpression<D, T, E>& vec) {
+	return vec.derived();
+}
+
+template <unsigned D, typename T, typename E>
+constexpr internal::VectorBinary<D, T, internal::Multiply, E, internal::VectorBroadcast<D, T>> operator-(const VectorExpression<D, T, E>& vec) {
+	return vec * (-1);
+}
+
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::isNan() const {
 	for (unsigned i = 0; i < D; ++i)
 		if (_v[i] != _v[i])
 			return true;
 	return false;
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::dot(const Vector<D>& vec) const {
-	Real result = 0;
-	for (unsigned i = 0; i < D; ++i)
-		result += _v[i] * vec._v[i];
-	return result;
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::dot(const Vector<D, T>& vec) const {
+	if (simd()) return Kernels::dot(_v.v, vec._v.v);
+	return internal::ScalarKernels<Layout::size, T>::dot(_v.v, vec._v.v);
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::dotself() const {
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::dotself() const {
 	return dot(*this);
 }
 
-template <unsigned D>
-inline Real Vector<D>::length() const {
-	return std::sqrt(dot(*this));
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::length() const {
+	return cmath::sqrt(dot(*this));
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::cross(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr Vector<D, T> Vector<D, T>::cross(const Vector<D, T>& vec) const {
 	static_assert(D == 3, "Invalid number of dimentions for cross product");
 	return {
 		_v[1]*vec._v[2] - _v[2] * vec._v[1],
@@ -173,37 +518,37 @@ inline constexpr Vector<D> Vector<D>::cross(const Vector<D>& vec) const {
 	};
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::unit() const {
+template <unsigned D, typename T>
+inline constexpr Vector<D, T> Vector<D, T>::unit() const {
 	return (*this) / length();
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::x() const {
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::x() const {
 	static_assert(D >= 1, "Invalid number of dimentions for x component");
 	return _v[0];
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::y() const {
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::y() const {
 	static_assert(D >= 2, "Invalid number of dimentions for y component");
 	return _v[1];
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::z() const {
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::z() const {
 	static_assert(D >= 3, "Invalid number of dimentions for z component");
 	return _v[2];
 }
 
-template <unsigned D>
-inline constexpr Real Vector<D>::t() const {
+template <unsigned D, typename T>
+inline constexpr T Vector<D, T>::t() const {
 	static_assert(D >= 4, "Invalid number of dimentions for t component");
 	return _v[3];
 }
 
-template <unsigned D>
-inline constexpr const Real& Vector<D>::operator()(unsigned i) const {
+template <unsigned D, typename T>
+inline constexpr const T& Vector<D, T>::operator()(unsigned i) const {
 #ifdef DEBUG
 	if (i >= D)
 		throw std::logic_error("Invalid index");
@@ -212,8 +557,8 @@ inline constexpr const Real& Vector<D>::operator()(unsigned i) const {
 	return _v[i];
 }
 
-template <unsigned D>
-inline constexpr Real& Vector<D>::operator()(unsigned i) {
+template <unsigned D, typename T>
+inline constexpr T& Vector<D, T>::operator()(unsigned i) {
 #ifdef DEBUG
 	if (i >= D)
 		throw std::logic_error("Invalid index");
@@ -222,146 +567,124 @@ inline constexpr Real& Vector<D>::operator()(unsigned i) {
 	return _v[i];
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator+(const Vector<D>& vec) const {
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] + vec._v[i];
-	return result;
-}
-
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator-(const Vector<D>& vec) const {
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] - vec._v[i];
-	return result;
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::operator+=(const VectorExpression<D, T, E>& vec) {
+	return update<internal::Add>(vec.derived());
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator+() const {
-	return (*this);
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::operator-=(const VectorExpression<D, T, E>& vec) {
+	return update<internal::Subtract>(vec.derived());
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator-() const {
-	return (*this) * (-1);
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::operator*=(const VectorExpression<D, T, E>& vec) {
+	return update<internal::Multiply>(vec.derived());
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator*(const Vector<D>& vec) const {
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] * vec._v[i];
-	return result;
-}
-
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator*(const Real& real) const {
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] * real;
-	return result;
-}
-
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator/(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+template <typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::operator/=(const VectorExpression<D, T, E>& vec) {
 #ifdef DEBUG
 	for (unsigned i = 0; i < D; ++i)
-		if (vec._v[i] == 0)
+		if (vec(i) == 0)
 			throw std::logic_error("Can't divide by zero");
 #endif
 
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] / vec._v[i];
-	return result;
+	return update<internal::Divide>(vec.derived());
+}
+
+template <unsigned D, typename T>
+inline constexpr Vector<D, T>& Vector<D, T>::operator*=(const T& real) {
+	return update<internal::Multiply>(internal::VectorBroadcast<D, T>(real));
 }
 
-template <unsigned D>
-inline constexpr Vector<D> Vector<D>::operator/(const Real& real) const {
+template <unsigned D, typename T>
+inline constexpr Vector<D, T>& Vector<D, T>::operator/=(const T& real) {
 #ifdef DEBUG
 	if (real == 0)
 		throw std::logic_error("Can't divide by zero");
 #endif
 
-	Vector<D> result;
-	for (unsigned i = 0; i < D; ++i)
-		result._v[i] = _v[i] / real;
-	return result;
+	return update<internal::Divide>(internal::VectorBroadcast<D, T>(real));
 }
 
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator+=(const Vector<D>& vec) {
-	return (*this) = (*this) + vec;
-}
-
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator-=(const Vector<D>& vec) {
-	return (*this) = (*this) - vec;
-}
-
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator*=(const Vector<D>& vec) {
-	return (*this) = (*this) * vec;
-}
-
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator/=(const Vector<D>& vec) {
-	return (*this) = (*this) / vec;
-}
-
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator*=(const Real& real) {
-	return (*this) = (*this) / real;
-}
-
-template <unsigned D>
-inline constexpr Vector<D>& Vector<D>::operator/=(const Real& real) {
-	return (*this) = (*this) / real;
-}
-
-template <unsigned D>
-inline constexpr bool Vector<D>::operator>(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::operator>(const Vector<D, T>& vec) const {
 	return dotself() > vec.dotself();
 }
 
-template <unsigned D>
-inline constexpr bool Vector<D>::operator<(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::operator<(const Vector<D, T>& vec) const {
 	return dotself() < vec.dotself();
 }
 
-template <unsigned D>
-inline constexpr bool Vector<D>::operator>=(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::operator>=(const Vector<D, T>& vec) const {
 	return dotself() >= vec.dotself();
 }
 
-template <unsigned D>
-inline constexpr bool Vector<D>::operator<=(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::operator<=(const Vector<D, T>& vec) const {
 	return dotself() <= vec.dotself();
 }
 
-template <unsigned D>
-inline constexpr bool Vector<D>::operator==(const Vector<D>& vec) const {
+template <unsigned D, typename T>
+inline constexpr bool Vector<D, T>::operator==(const Vector<D, T>& vec) const {
 	for (unsigned i = 0; i < D; ++i)
 		if (_v[i] != vec._v[i])
 			return false;
 	return true;
 }
 
-template <unsigned D>
+template <unsigned D, typename T>
 template <unsigned E>
-inline constexpr Vector<E> Vector<D>::subvector() const {
+inline constexpr Vector<E, T> Vector<D, T>::subvector() const {
 	static_assert(E <= D, "Invalid number of dimentions for subvector");
-	Vector<E> result;
+	Vector<E, T> result;
 	for (unsigned i = 0; i < E; ++i)
 		result(i) = _v[i];
 	return result;
 }
 
-template <unsigned D>
-void Vector<D>::swapline(unsigned a, unsigned b) {
+template <unsigned D, typename T>
+void Vector<D, T>::swapline(unsigned a, unsigned b) {
 	std::swap(_v[a], _v[b]);
 }
 
+template <unsigned D, typename T>
+inline constexpr void Vector<D, T>::clearPadding() {
+	for (unsigned i = D; i < Layout::size; ++i)
+		_v[i] = 0;
+}
+
+template <unsigned D, typename T>
+template <typename Op, typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::update(const E& expr) {
+	// Each component only depends on the same component of the operands, so expr may refer to this vector
+	return update<Op>(expr, std::integral_constant<bool, Layout::simd>());
+}
+
+template <unsigned D, typename T>
+template <typename Op, typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::update(const E& expr, std::false_type) {
+	for (unsigned i = 0; i < D; ++i)
+		_v[i] = Op::apply(_v[i], expr.element(i));
+	return *this;
+}
+
+template <unsigned D, typename T>
+template <typename Op, typename E>
+inline constexpr Vector<D, T>& Vector<D, T>::update(const E& expr, std::true_type) {
+	if (!simd()) return update<Op>(expr, std::false_type());
+	
+	for (unsigned p = 0; p < Layout::size; p += simd::width)
+		simd::store(_v.v + p, Op::apply(simd::load(_v.v + p), expr.pack(p)));
+	clearPadding();
+	return *this;
+}
+
 } // math namespace
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <math/Real>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/Simd>
+#include <math/AlignedAllocator>
+#include <math/ThreadPool>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace math {
+
+/*!
+ * \brief The VectorArray class stores many vectors of D components, each component in its own array.
+ *
+ * With the x of every vector side by side, then every y, and so on, a SIMD register holds the same component of
+ * several vectors. The bulk operations below then treat simd::width vectors per instruction, and no lane is wasted
+ * on padding or on shuffling components around, as happens with an array of Vector.
+ *
+ * Each component array starts 32-byte aligned and is padded with zeros to a whole number of registers. The operations
+ * below keep the padding zero, except scale() by an infinite or NaN factor.
+ */
+template <unsigned D>
+class VectorArray {
+public:
+
+	VectorArray();
+
+	/// Makes size null vectors.
+	explicit VectorArray(std::size_t size);
+
+	/// Copies the vectors.
+	explicit VectorArray(const std::vector<Vector<D>>& vectors);
+
+	/// Copies the vectors back into an array of Vector.
+	std::vector<Vector<D>> toVectors() const;
+
+	std::size_t size() const;
+
+	/// Changes the number of vectors. New vectors are null.
+	void resize(std::size_t size);
+
+	Vector<D> get(std::size_t i) const;
+	void set(std::size_t i, const Vector<D>& vec);
+
+	/// The array of a component, holding size() values.
+	Real* component(unsigned c);
+	const Real* component(unsigned c) const;
+
+	/// Adds the vectors of another array, of the same size, to these ones.
+	void add(const VectorArray<D>& other);
+
+	/// Adds the same vector to all vectors.
+	void add(const Vector<D>& vec);
+
+	/// Multiplies all vectors by a scalar.
+	void scale(Real real);
+
+	/// Writes the dot product of each vector with vec to out, which must hold size() values.
+	void dot(const Vector<D>& vec, Real* out) const;
+
+	/// Writes the dot product of each vector with the matching one of another array to out.
+	void dot(const VectorArray<D>& other, Real* out) const;
+
+	/// Writes the cross product of each vector with the matching one of another array to out. Only for D = 3.
+	void cross(const VectorArray<D>& other, VectorArray<D>& out) const;
+
+	/// Writes the length of each vector to out.
+	void lengths(Real* out) const;
+
+	/// Makes every vector unit. Null vectors stay null.
+	void normalize();
+
+	/// The smallest value of each component. Infinity when there are no vectors.
+	Vector<D> min() const;
+
+	/// The largest value of each component. Minus infinity when there are no vectors.
+	Vector<D> max() const;
+
+	/// Writes mat * v for each vector v to out.
+	template <unsigned M>
+	void multiply(const Matrix<M, D>& mat, VectorArray<M>& out) const;
+
+	/// \brief Writes the affine transform of each vector, taken as a point, to out. The last row of mat is ignored.
+	///
+	/// Like the other transforms below, out may be this array, and when a pool is given the vectors are split between
+	/// its threads.
+	void transformPoints(const Matrix<D+1, D+1>& mat, VectorArray<D>& out, ThreadPool* pool = nullptr) const;
+
+	/// Writes the affine transform of each vector, taken as a point, to out. The last column of mat is the translation.
+	void transformPoints(const Matrix<D, D+1>& mat, VectorArray<D>& out, ThreadPool* pool = nullptr) const;
+
+	/// Writes the linear part of the affine transform of each vector, taken as a direction, to out.
+	void transformVectors(const Matrix<D+1, D+1>& mat, VectorArray<D>& out, ThreadPool* pool = nullptr) const;
+
+	/// Writes the linear part of the affine transform of each vector, taken as a direction, to out.
+	void transformVectors(const Matrix<D, D+1>& mat, VectorArray<D>& out, ThreadPool* pool = nullptr) const;
+
+	/// \brief Writes each vector, taken as a surface normal, moved by the linear transform mat to out.
+	///
+	/// Normals go through the inverse transpose of mat, which keeps them perpendicular to the transformed surface, and
+	/// come out unit. Throws if mat is singular.
+	void transformNormals(const Matrix<D, D>& mat, VectorArray<D>& out, ThreadPool* pool = nullptr) const;
+
+private:
+
+	template <unsigned E> friend class VectorArray;
+
+	/// The number of values reserved per component, a whole number of 32 bytes so that every component stays aligned.
+	std::size_t stride() const;
+
+	/// The lanes of the register starting at vector i that hold vectors, not padding.
+	simd::Mask lanes(std::size_t i) const;
+
+	/// Registers of vectors handed to a thread at a time by the transforms.
+	static constexpr std::size_t grain = 256;
+
+	/// Writes the first D rows of mat times each vector to out, adding the column D if translate, and making the
+	/// results unit if unit.
+	template <unsigned R, unsigned C>
+	void transform(const Matrix<R, C>& mat, bool translate, bool unit, VectorArray<D>& out, ThreadPool* pool) const;
+
+	std::size_t _size;
+	std::vector<Real, AlignedAllocator<Real>> _data;
+
+};
+
+template <unsigned D>
+inline VectorArray<D>::VectorArray() : _size(0) {
+
+}
+
+template <unsigned D>
+inline VectorArray<D>::VectorArray(std::size_t size) : _size(0) {
+	resize(size);
+}
+
+template <unsigned D>
+inline VectorArray<D>::VectorArray(const std::vector<Vector<D>>& vectors) : _size(0) {
+	resize(vectors.size());
+	for (std::size_t i = 0; i < _size; ++i)
+		set(i, vectors[i]);
+}
+
+template <unsigned D>
+inline std::vector<Vector<D>> VectorArray<D>::toVectors() const {
+	std::vector<Vector<D>> result(_size);
+	for (std::size_t i = 0; i < _size; ++i)
+		result[i] = get(i);
+	return result;
+}
+
+template <unsigned D>
+inline std::size_t VectorArray<D>::size() const {
+	return _size;
+}
+
+template <unsigned D>
+inline std::size_t VectorArray<D>::stride() const {
+	const std::size_t block = 32 / sizeof(Real);
+	return (_size + block - 1) / block * block;
+}
+
+template <unsigned D>
+inline void VectorArray<D>::resize(std::size_t size) {
+	if (size == _size) return;
+
+	std::size_t oldStride = stride();
+	std::size_t oldSize = _size;
+	std::vector<Real, AlignedAllocator<Real>> old;
+	old.swap(_data);
+
+	_size = size;
+	_data.assign(D * stride(), 0);
+	for (unsigned c = 0; c < D; ++c)
+		std::copy(old.begin() + c * oldStride, old.begin() + c * oldStride + std::min(oldSize, size), _data.begin() + c * stride());
+}
+
+template <unsigned D>
+inline Vector<D> VectorArray<D>::get(std::size_t i) const {
+	Vector<D> result;
+	for (unsigned c = 0; c < D; ++c)
+		result(c) = component(c)[i];
+	return result;
+}
+
+template <unsigned D>
+inline void VectorArray<D>::set(std::size_t i, const Vector<D>& vec) {
+	for (unsigned c = 0; c < D; ++c)
+		component(c)[i] = vec(c);
+}
+
+template <unsigned D>
+inline Real* VectorArray<D>::component(unsigned c) {
+	return _data.data() + c * stride();
+}
+
+template <unsigned D>
+inline const Real* VectorArray<D>::component(unsigned c) const {
+	return _data.data() + c * stride();
+}
+
+template <unsigned D>
+inline simd::Mask VectorArray<D>::lanes(std::size_t i) const {
+	if (i + simd::width <= _size) return simd::fromBits(simd::allBits);
+	return simd::fromBits((1u << (_size - i)) - 1);
+}
+
+// The kernels below go through whole registers, padding included, whenever they write to their own arrays.
+// Writing to caller arrays, they finish the last partial register one value at a time.
+
+template <unsigned D>
+inline void VectorArray<D>::add(const VectorArray<D>& other) {
+	if (other._size != _size) throw std::logic_error("VectorArrays of different sizes");
+
+	for (std::size_t i = 0; i < _data.size(); i += simd::width)
+		simd::store(&_data[i], simd::load(&_data[i]) + simd::load(&other._data[i]));
+}
+
+template <unsigned D>
+inline void VectorArray<D>::add(const Vector<D>& vec) {
+	for (unsigned c = 0; c < D; ++c) {
+		Real* values = component(c);
+		const simd::Pack offset = simd::broadcast(vec(c));
+		const simd::Pack zero = simd::broadcast(0);
+		for (std::size_t i = 0; i < _size; i += simd::width)
+			simd::store(values + i, simd::load(values + i) + simd::select(lanes(i), offset, zero));
+	}
+}
+
+template <unsigned D>
+inline void VectorArray<D>::scale(Real real) {
+	simd::Pack factor = simd::broadcast(real);
+	for (std::size_t i = 0; i < _data.size(); i += simd::width)
+		simd::store(&_data[i], simd::load(&_data[i]) * factor);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::dot(const Vector<D>& vec, Real* out) const {
+	std::size_t i = 0;
+	for (; i + simd::width <= _size; i += simd::width) {
+		simd::Pack sum = simd::load(component(0) + i) * simd::broadcast(vec(0));
+		for (unsigned c = 1; c < D; ++c)
+			sum = sum + simd::load(component(c) + i) * simd::broadcast(vec(c));
+		simd::store(out + i, sum);
+	}
+
+	for (; i < _size; ++i) {
+		Real sum = component(0)[i] * vec(0);
+		for (unsigned c = 1; c < D; ++c)
+			sum += component(c)[i] * vec(c);
+		out[i] = sum;
+	}
+}
+
+template <unsigned D>
+inline void VectorArray<D>::dot(const VectorArray<D>& other, Real* out) const {
+	if (other._size != _size) throw std::logic_error("VectorArrays of different sizes");
+
+	std::size_t i = 0;
+	for (; i + simd::width <= _size; i += simd::width) {
+		simd::Pack sum = simd::load(component(0) + i) * simd::load(other.component(0) + i);
+		for (unsigned c = 1; c < D; ++c)
+			sum = sum + simd::load(component(c) + i) * simd::load(other.component(c) + i);
+		simd::store(out + i, sum);
+	}
+
+	for (; i < _size; ++i) {
+		Real sum = component(0)[i] * other.component(0)[i];
+		for (unsigned c = 1; c < D; ++c)
+			sum += component(c)[i] * other.component(c)[i];
+		out[i] = sum;
+	}
+}
+
+template <unsigned D>
+inline void VectorArray<D>::cross(const VectorArray<D>& other, VectorArray<D>& out) const {
+	static_assert(D == 3, "Invalid number of dimentions for cross product");
+	if (other._size != _size) throw std::logic_error("VectorArrays of different sizes");
+	out.resize(_size);
+
+	for (std::size_t i = 0; i < _size; i += simd::width) {
+		simd::Pack ax = simd::load(component(0) + i), ay = simd::load(component(1) + i), az = simd::load(component(2) + i);
+		simd::Pack bx = simd::load(other.component(0) + i), by = simd::load(other.component(1) + i), bz = simd::load(other.component(2) + i);
+		simd::store(out.component(0) + i, ay * bz - az * by);
+		simd::store(out.component(1) + i, az * bx - ax * bz);
+		simd::store(out.component(2) + i, ax * by - ay * bx);
+	}
+}
+
+template <unsigned D>
+inline void VectorArray<D>::lengths(Real* out) const {
+	dot(*this, out);
+	std::size_t i = 0;
+	for (; i + simd::width <= _size; i += simd::width)
+		simd::store(out + i, simd::sqrt(simd::load(out + i)));
+	for (; i < _size; ++i)
+		out[i] = std::sqrt(out[i]);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::normalize() {
+	const simd::Pack zero = simd::broadcast(0);
+	const simd::Pack one = simd::broadcast(1);
+
+	for (std::size_t i = 0; i < _size; i += simd::width) {
+		simd::Pack squared = simd::load(component(0) + i) * simd::load(component(0) + i);
+		for (unsigned c = 1; c < D; ++c)
+			squared = squared + simd::load(component(c) + i) * simd::load(component(c) + i);
+
+		// Null vectors, padding included, are divided by one instead
+		simd::Pack length = simd::select(squared == zero, one, simd::sqrt(squared));
+		for (unsigned c = 0; c < D; ++c)
+			simd::store(component(c) + i, simd::load(component(c) + i) / length);
+	}
+}
+
+template <unsigned D>
+inline Vector<D> VectorArray<D>::min() const {
+	Vector<D> result;
+	for (unsigned c = 0; c < D; ++c) {
+		const Real* values = component(c);
+		simd::Pack lowest = simd::broadcast(std::numeric_limits<Real>::infinity());
+		std::size_t i = 0;
+		for (; i + simd::width <= _size; i += simd::width) {
+			simd::Pack v = simd::load(values + i);
+			lowest = simd::select(v < lowest, v, lowest);
+		}
+
+		Real lanes[simd::width];
+		simd::store(lanes, lowest);
+		result(c) = *std::min_element(lanes, lanes + simd::width);
+		for (; i < _size; ++i)
+			result(c) = std::min(result(c), values[i]);
+	}
+	return result;
+}
+
+template <unsigned D>
+inline Vector<D> VectorArray<D>::max() const {
+	Vector<D> result;
+	for (unsigned c = 0; c < D; ++c) {
+		const Real* values = component(c);
+		simd::Pack highest = simd::broadcast(-std::numeric_limits<Real>::infinity());
+		std::size_t i = 0;
+		for (; i + simd::width <= _size; i += simd::width) {
+			simd::Pack v = simd::load(values + i);
+			highest = simd::select(v > highest, v, highest);
+		}
+
+		Real lanes[simd::width];
+		simd::store(lanes, highest);
+		result(c) = *std::max_element(lanes, lanes + simd::width);
+		for (; i < _size; ++i)
+			result(c) = std::max(result(c), values[i]);
+	}
+	return result;
+}
+
+template <unsigned D>
+template <unsigned M>
+inline void VectorArray<D>::multiply(const Matrix<M, D>& mat, VectorArray<M>& out) const {
+	if (static_cast<const void*>(&out) == this) throw std::logic_error("Can't multiply a VectorArray in place");
+	out.resize(_size);
+
+	for (std::size_t i = 0; i < _size; i += simd::width) {
+		for (unsigned r = 0; r < M; ++r) {
+			simd::Pack sum = simd::load(component(0) + i) * simd::broadcast(mat(r, 0));
+			for (unsigned c = 1; c < D; ++c)
+				sum = sum + simd::load(component(c) + i) * simd::broadcast(mat(r, c));
+			simd::store(out.component(r) + i, sum);
+		}
+	}
+}
+
+template <unsigned D>
+constexpr std::size_t VectorArray<D>::grain;
+
+template <unsigned D>
+inline void VectorArray<D>::transformPoints(const Matrix<D+1, D+1>& mat, VectorArray<D>& out, ThreadPool* pool) const {
+	transform(mat, true, false, out, pool);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::transformPoints(const Matrix<D, D+1>& mat, VectorArray<D>& out, ThreadPool* pool) const {
+	transform(mat, true, false, out, pool);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::transformVectors(const Matrix<D+1, D+1>& mat, VectorArray<D>& out, ThreadPool* pool) const {
+	transform(mat, false, false, out, pool);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::transformVectors(const Matrix<D, D+1>& mat, VectorArray<D>& out, ThreadPool* pool) const {
+	transform(mat, false, false, out, pool);
+}
+
+template <unsigned D>
+inline void VectorArray<D>::transformNormals(const Matrix<D, D>& mat, VectorArray<D>& out, ThreadPool* pool) const {
+	transform(mat.inverse().transpost(), false, true, out, pool);
+}
+
+template <unsigned D>
+template <unsigned R, unsigned C>
+inline void VectorArray<D>::transform(const Matrix<R, C>& mat, bool translate, bool unit, VectorArray<D>& out,
+                                      ThreadPool* pool) const {
+	out.resize(_size);
+
+	const simd::Pack zero = simd::broadcast(0);
+	const simd::Pack one = simd::broadcast(1);
+
+	// Each register of results is computed whole before being stored, so out may be this very array
+	auto body = [&](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin * simd::width; i < end * simd::width; i += simd::width) {
+			simd::Pack result[D];
+			for (unsigned r = 0; r < D; ++r) {
+				simd::Pack sum = simd::load(component(0) + i) * simd::broadcast(mat(r, 0));
+				for (unsigned c = 1; c < D; ++c)
+					sum = sum + simd::load(component(c) + i) * simd::broadcast(mat(r, c));
+				result[r] = sum;
+			}
+
+			// The padding is null, so only the translation could move it
+			if (translate) {
+				simd::Mask valid = lanes(i);
+				for (unsigned r = 0; r < D; ++r)
+					result[r] = result[r] + simd::select(valid, simd::broadcast(mat(r, D)), zero);
+			}
+
+			if (unit) {
+				simd::Pack squared = result[0] * result[0];
+				for (unsigned r = 1; r < D; ++r)
+					squared = squared + result[r] * result[r];
+				simd::Pack length = simd::select(squared == zero, one, simd::sqrt(squared));
+				for (unsigned r = 0; r < D; ++r)
+					result[r] = result[r] / length;
+			}
+
+			for (unsigned r = 0; r < D; ++r)
+				simd::store(out.component(r) + i, result[r]);
+		}
+	};
+
+	std::size_t registers = (_size + simd::width - 1) / simd::width;
+	if (pool && registers > grain) pool->parallelFor(registers, grain, body);
+	else body(0, registers);
+}
+
+}  // math namespace
@@ -0,0 +1,157 @@
+#include <math/ConjugateGradient>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace math;
+
+namespace {
+	/// Elements per chunk of a pass over vectors
+	const std::size_t grain = 8192;
+
+	/// Two sums taken in the same pass
+	struct Sums {
+		Accumulator first = 0;
+		Accumulator second = 0;
+
+		Sums& operator+=(const Sums& other) {
+			first += other.first;
+			second += other.second;
+			return *this;
+		}
+	};
+
+	/// \brief Runs body(begin, end) over [0, n) in chunks of grain elements, and adds the sums they return in order.
+	///
+	/// The chunks don't depend on the pool, so neither does the rounding of the total.
+	template <typename Body>
+	Sums reduce(std::size_t n, ThreadPool* pool, const Body& body) {
+		std::size_t chunks = (n + grain - 1) / grain;
+		std::vector<Sums> sums(chunks);
+		auto run = [&](std::size_t begin, std::size_t end) {
+			for (std::size_t c = begin; c < end; ++c)
+				sums[c] = body(c * grain, std::min(n, (c + 1) * grain));
+		};
+		if (pool && chunks > 1) pool->parallelFor(chunks, 1, run);
+		else run(0, chunks);
+
+		Sums total;
+		for (const Sums& sum : sums)
+			total += sum;
+		return total;
+	}
+}
+
+ConjugateGradient::ConjugateGradient(const SparseMatrix& matrix, ThreadPool* pool)
+	: _matrix(matrix), _pool(pool), _tolerance(std::sqrt(std::numeric_limits<Real>::epsilon())), _maxIterations(matrix.rows()), _iterations(0), _residual(0) {
+	if (matrix.rows() != matrix.cols()) throw std::logic_error("Conjugate gradient needs a square matrix");
+
+	// A null diagonal cell can't be inverted, and leaves its row unscaled
+	_inverseDiagonal = matrix.diagonal();
+	for (Real& cell : _inverseDiagonal)
+		cell = cell != 0 ? 1 / cell : 1;
+}
+
+void ConjugateGradient::setTolerance(Real tolerance) {
+	_tolerance = tolerance;
+}
+
+Real ConjugateGradient::tolerance() const {
+	return _tolerance;
+}
+
+void ConjugateGradient::setMaxIterations(std::size_t iterations) {
+	_maxIterations = iterations;
+}
+
+std::size_t ConjugateGradient::maxIterations() const {
+	return _maxIterations;
+}
+
+bool ConjugateGradient::solve(const std::vector<Real>& b, std::vector<Real>& x) {
+	const std::size_t n = _matrix.rows();
+	if (b.size() != n) throw std::logic_error("Vector of the wrong size");
+	if (x.size() != n) x.assign(n, 0);
+
+	std::vector<Real> r(n), z(n), p(n), q(n);
+	const Real* inverse = _inverseDiagonal.data();
+	_iterations = 0;
+
+	// r = b - A * x, z = M^-1 * r, p = z
+	_matrix.multiply(x, q, _pool);
+	Sums start = reduce(n, _pool, [&](std::size_t begin, std::size_t end) {
+		Sums sums;
+		for (std::size_t i = begin; i < end; ++i) {
+			r[i] = b[i] - q[i];
+			z[i] = inverse[i] * r[i];
+			p[i] = z[i];
+			sums.first += Accumulator(r[i]) * z[i];
+			sums.second += Accumulator(b[i]) * b[i];
+		}
+		return sums;
+	});
+	Accumulator rz = start.first;
+	Accumulator rr = reduce(n, _pool, [&](std::size_t begin, std::size_t end) {
+		Sums sums;
+		for (std::size_t i = begin; i < end; ++i)
+			sums.first += Accumulator(r[i]) * r[i];
+		return sums;
+	}).first;
+
+	// A null b has the solution x = 0, whatever x started from
+	if (start.second == 0) {
+		std::fill(x.begin(), x.end(), Real(0));
+		_residual = 0;
+		return true;
+	}
+	const Accumulator norm = std::sqrt(start.second);
+	const Accumulator target = _tolerance * norm;
+
+	while (std::sqrt(rr) > target && _iterations < _maxIterations) {
+		_matrix.multiply(p, q, _pool);
+		Accumulator pq = reduce(n, _pool, [&](std::size_t begin, std::size_t end) {
+			Sums sums;
+			for (std::size_t i = begin; i < end; ++i)
+				sums.first += Accumulator(p[i]) * q[i];
+			return sums;
+		}).first;
+		// Only a matrix that is not positive definite gives a null or negative curvature
+		if (pq <= 0) break;
+		Real alpha = Real(rz / pq);
+
+		// One pass updates x and r, preconditions r, and sums both products the next step needs
+		Sums next = reduce(n, _pool, [&](std::size_t begin, std::size_t end) {
+			Sums sums;
+			for (std::size_t i = begin; i < end; ++i) {
+				x[i] += alpha * p[i];
+				r[i] -= alpha * q[i];
+				z[i] = inverse[i] * r[i];
+				sums.first += Accumulator(r[i]) * z[i];
+				sums.second += Accumulator(r[i]) * r[i];
+			}
+			return sums;
+		});
+
+		Real beta = Real(next.first / rz);
+		rz = next.first;
+		rr = next.second;
+		reduce(n, _pool, [&](std::size_t begin, std::size_t end) {
+			for (std::size_t i = begin; i < end; ++i)
+				p[i] = z[i] + beta * p[i];
+			return Sums();
+		});
+		++_iterations;
+	}
+
+	_residual = Real(std::sqrt(rr) / norm);
+	return std::sqrt(rr) <= target;
+}
+
+std::size_t ConjugateGradient::iterations() const {
+	return _iterations;
+}
+
+Real ConjugateGradient::residual() const {
+	return _residual;
+}
@@ -0,0 +1,172 @@
+#include <math/DenseMatrix>
+#include <math/Simd>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+using namespace math;
+
+namespace {
+	/// Rows of the left matrix per block, which is also the unit of work of the threads
+	const std::size_t rowBlock = 64;
+
+	/// Rows and columns of the block of the right matrix kept in the cache, 128 KB in double precision
+	const std::size_t innerBlock = 128;
+	const std::size_t colBlock = 128;
+}
+
+DenseMatrix::DenseMatrix() : _rows(0), _cols(0) {
+
+}
+
+DenseMatrix::DenseMatrix(std::size_t rows, std::size_t cols) : _rows(rows), _cols(cols), _v(rows * cols, Real(0)) {
+
+}
+
+DenseMatrix DenseMatrix::eye(std::size_t n) {
+	DenseMatrix result(n, n);
+	for (std::size_t i = 0; i < n; ++i)
+		result(i, i) = 1;
+	return result;
+}
+
+std::size_t DenseMatrix::rows() const {
+	return _rows;
+}
+
+std::size_t DenseMatrix::cols() const {
+	return _cols;
+}
+
+Real& DenseMatrix::operator()(std::size_t i, std::size_t j) {
+#ifdef DEBUG
+	if (i >= _rows || j >= _cols) throw std::logic_error("Invalid index");
+#endif
+	return _v[i * _cols + j];
+}
+
+const Real& DenseMatrix::operator()(std::size_t i, std::size_t j) const {
+#ifdef DEBUG
+	if (i >= _rows || j >= _cols) throw std::logic_error("Invalid index");
+#endif
+	return _v[i * _cols + j];
+}
+
+Real* DenseMatrix::data() {
+	return _v.data();
+}
+
+const Real* DenseMatrix::data() const {
+	return _v.data();
+}
+
+DenseMatrix DenseMatrix::transpost() const {
+	DenseMatrix result(_cols, _rows);
+	for (std::size_t i = 0; i < _rows; ++i)
+		for (std::size_t j = 0; j < _cols; ++j)
+			result._v[j * _rows + i] = _v[i * _cols + j];
+	return result;
+}
+
+DenseMatrix& DenseMatrix::operator+=(const DenseMatrix& other) {
+	if (_rows != other._rows || _cols != other._cols) throw std::logic_error("Matrices of different sizes");
+	for (std::size_t c = 0; c < _v.size(); ++c)
+		_v[c] += other._v[c];
+	return *this;
+}
+
+DenseMatrix& DenseMatrix::operator-=(const DenseMatrix& other) {
+	if (_rows != other._rows || _cols != other._cols) throw std::logic_error("Matrices of different sizes");
+	for (std::size_t c = 0; c < _v.size(); ++c)
+		_v[c] -= other._v[c];
+	return *this;
+}
+
+DenseMatrix& DenseMatrix::operator*=(Real real) {
+	for (Real& cell : _v)
+		cell *= real;
+	return *this;
+}
+
+DenseMatrix DenseMatrix::operator+(const DenseMatrix& other) const {
+	DenseMatrix result = *this;
+	return result += other;
+}
+
+DenseMatrix DenseMatrix::operator-(const DenseMatrix& other) const {
+	DenseMatrix result = *this;
+	return result -= other;
+}
+
+DenseMatrix DenseMatrix::operator*(Real real) const {
+	DenseMatrix result = *this;
+	return result *= real;
+}
+
+DenseMatrix DenseMatrix::operator*(const DenseMatrix& other) const {
+	DenseMatrix result;
+	multiply(*this, other, result);
+	return result;
+}
+
+std::vector<Real> DenseMatrix::operator*(const std::vector<Real>& vec) const {
+	if (vec.size() != _cols) throw std::logic_error("Vector of the wrong size");
+	std::vector<Real> result(_rows);
+	for (std::size_t i = 0; i < _rows; ++i) {
+		const Real* row = &_v[i * _cols];
+		Accumulator sum = 0;
+		for (std::size_t j = 0; j < _cols; ++j)
+			sum += row[j] * vec[j];
+		result[i] = Real(sum);
+	}
+	return result;
+}
+
+void DenseMatrix::multiply(const DenseMatrix& a, const DenseMatrix& b, DenseMatrix& result, ThreadPool* pool) {
+	if (a._cols != b._rows) throw std::logic_error("Matrices of incompatible sizes");
+	if (&result == &a || &result == &b) {
+		DenseMatrix product;
+		multiply(a, b, product, pool);
+		result = std::move(product);
+		return;
+	}
+
+	const std::size_t n = a._rows, inner = a._cols, m = b._cols;
+	result = DenseMatrix(n, m);
+	Real* c = result._v.data();
+	const Real* left = a._v.data();
+	const Real* right = b._v.data();
+
+	// Each chunk is a block of rows of the result, which no other chunk writes
+	auto body = [=](std::size_t begin, std::size_t end) {
+		for (std::size_t block = begin; block < end; ++block) {
+			std::size_t i0 = block * rowBlock, i1 = std::min(n, i0 + rowBlock);
+			for (std::size_t k0 = 0; k0 < inner; k0 += innerBlock) {
+				std::size_t k1 = std::min(inner, k0 + innerBlock);
+				for (std::size_t j0 = 0; j0 < m; j0 += colBlock) {
+					std::size_t j1 = std::min(m, j0 + colBlock);
+					std::size_t vectorEnd = j0 + (j1 - j0) / simd::width * simd::width;
+
+					// Row i of the result gathers row k of b times a(i, k), along contiguous cells
+					for (std::size_t i = i0; i < i1; ++i) {
+						Real* row = c + i * m;
+						for (std::size_t k = k0; k < k1; ++k) {
+							Real aik = left[i * inner + k];
+							const Real* line = right + k * m;
+							simd::Pack factor = simd::broadcast(aik);
+							std::size_t j = j0;
+							for (; j < vectorEnd; j += simd::width)
+								simd::store(row + j, simd::load(row + j) + factor * simd::load(line + j));
+							for (; j < j1; ++j)
+								row[j] += aik * line[j];
+						}
+					}
+				}
+			}
+		}
+	};
+
+	std::size_t blocks = (n + rowBlock - 1) / rowBlock;
+	if (pool && blocks > 1) pool->parallelFor(blocks, 1, body);
+	else body(0, blocks);
+}
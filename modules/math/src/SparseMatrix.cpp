@@ -0,0 +1,121 @@
+#include <math/SparseMatrix>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace math;
+
+namespace {
+	/// Rows per chunk of a threaded product, enough to outweigh handing the chunk out
+	const std::size_t rowGrain = 4096;
+}
+
+SparseMatrix::SparseMatrix() : _rows(0), _cols(0), _rowStarts(1, 0) {
+
+}
+
+SparseMatrix::SparseMatrix(std::size_t rows, std::size_t cols, std::vector<Entry> entries)
+	: _rows(rows), _cols(cols), _rowStarts(rows + 1, 0) {
+	for (const Entry& entry : entries)
+		if (entry.row >= rows || entry.col >= cols) throw std::logic_error("Entry out of the matrix");
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.row < b.row || (a.row == b.row && a.col < b.col);
+	});
+
+	_columns.reserve(entries.size());
+	_values.reserve(entries.size());
+	for (std::size_t k = 0; k < entries.size(); ++k) {
+		const Entry& entry = entries[k];
+		bool repeated = k > 0 && entries[k - 1].row == entry.row && entries[k - 1].col == entry.col;
+		if (repeated) {
+			_values.back() += entry.value;
+		} else {
+			_columns.push_back(entry.col);
+			_values.push_back(entry.value);
+			++_rowStarts[entry.row + 1];
+		}
+	}
+
+	// Counts per row to starts
+	for (std::size_t i = 0; i < rows; ++i)
+		_rowStarts[i + 1] += _rowStarts[i];
+}
+
+std::size_t SparseMatrix::rows() const {
+	return _rows;
+}
+
+std::size_t SparseMatrix::cols() const {
+	return _cols;
+}
+
+std::size_t SparseMatrix::nonZeros() const {
+	return _values.size();
+}
+
+Real SparseMatrix::operator()(std::size_t i, std::size_t j) const {
+#ifdef DEBUG
+	if (i >= _rows || j >= _cols) throw std::logic_error("Invalid index");
+#endif
+	auto begin = _columns.begin() + _rowStarts[i], end = _columns.begin() + _rowStarts[i + 1];
+	auto found = std::lower_bound(begin, end, j);
+	if (found == end || *found != j) return 0;
+	return _values[found - _columns.begin()];
+}
+
+Real& SparseMatrix::at(std::size_t i, std::size_t j) {
+	if (i >= _rows || j >= _cols) throw std::logic_error("Invalid index");
+	auto begin = _columns.begin() + _rowStarts[i], end = _columns.begin() + _rowStarts[i + 1];
+	auto found = std::lower_bound(begin, end, j);
+	if (found == end || *found != j) throw std::logic_error("Cell not stored");
+	return _values[found - _columns.begin()];
+}
+
+std::vector<Real> SparseMatrix::diagonal() const {
+	std::vector<Real> result(std::min(_rows, _cols));
+	for (std::size_t i = 0; i < result.size(); ++i)
+		result[i] = (*this)(i, i);
+	return result;
+}
+
+std::vector<Real> SparseMatrix::operator*(const std::vector<Real>& vec) const {
+	std::vector<Real> result;
+	multiply(vec, result);
+	return result;
+}
+
+void SparseMatrix::multiply(const std::vector<Real>& vec, std::vector<Real>& result, ThreadPool* pool) const {
+	if (vec.size() != _cols) throw std::logic_error("Vector of the wrong size");
+	if (&vec == &result) throw std::logic_error("Can't multiply a vector in place");
+	result.resize(_rows);
+
+	const std::size_t* starts = _rowStarts.data();
+	const std::size_t* columns = _columns.data();
+	const Real* values = _values.data();
+	const Real* x = vec.data();
+	Real* y = result.data();
+
+	auto body = [=](std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; ++i) {
+			Accumulator sum = 0;
+			for (std::size_t k = starts[i]; k < starts[i + 1]; ++k)
+				sum += values[k] * x[columns[k]];
+			y[i] = Real(sum);
+		}
+	};
+
+	if (pool && _rows > rowGrain) pool->parallelFor(_rows, rowGrain, body);
+	else body(0, _rows);
+}
+
+const std::vector<std::size_t>& SparseMatrix::rowStarts() const {
+	return _rowStarts;
+}
+
+const std::vector<std::size_t>& SparseMatrix::columns() const {
+	return _columns;
+}
+
+const std::vector<Real>& SparseMatrix::values() const {
+	return _values;
+}
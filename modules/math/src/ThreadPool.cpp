@@ -0,0 +1,94 @@
+#include <math/ThreadPool>
+#include <algorithm>
+
+using namespace math;
+
+ThreadPool::ThreadPool(unsigned threads)
+	: _generation(0), _busy(0), _stopping(false), _body(nullptr), _count(0), _grain(1), _next(0), _failed(false) {
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+	for (unsigned i = 1; i < threads; ++i)
+		_workers.emplace_back([this] { work(); });
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> loop(_loop);
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+
+	for (std::thread& worker : _workers)
+		worker.join();
+}
+
+unsigned ThreadPool::size() const {
+	return _workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, const Body& body) {
+	if (count == 0) return;
+	grain = std::max<std::size_t>(grain, 1);
+
+	// Nothing to share, don't wake anyone
+	if (_workers.empty() || count <= grain) {
+		for (std::size_t begin = 0; begin < count; begin += grain)
+			body(begin, std::min(begin + grain, count));
+		return;
+	}
+
+	std::lock_guard<std::mutex> loop(_loop);
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_body = &body;
+		_count = count;
+		_grain = grain;
+		_next = 0;
+		_failed = false;
+		_error = nullptr;
+		_busy = _workers.size();
+		++_generation;
+	}
+	_wake.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done.wait(lock, [this] { return _busy == 0; });
+	_body = nullptr;
+
+	if (_error) std::rethrow_exception(_error);
+}
+
+void ThreadPool::work() {
+	unsigned long seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&] { return _stopping || _generation != seen; });
+			if (_stopping) return;
+			seen = _generation;
+		}
+
+		runChunks();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (--_busy == 0) _done.notify_all();
+	}
+}
+
+void ThreadPool::runChunks() {
+	while (!_failed) {
+		std::size_t begin = _next.fetch_add(_grain);
+		if (begin >= _count) return;
+
+		try {
+			(*_body)(begin, std::min(begin + _grain, _count));
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (!_failed) _error = std::current_exception();
+			_failed = true;
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <math/ConjugateGradient>
+#include <math/SparseMatrix>
+#include <math/ThreadPool>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace math;
+
+namespace {
+
+/// A relative residual both precisions of Real reach, well above their rounding
+const Real tolerance = 1024 * std::numeric_limits<Real>::epsilon();
+
+/// The Laplacian of a side x side grid with fixed borders, plus weight on the diagonal of each node
+SparseMatrix gridLaplacian(std::size_t side, Real weight = 0) {
+	std::vector<SparseMatrix::Entry> entries;
+	for (std::size_t y = 0; y < side; ++y)
+		for (std::size_t x = 0; x < side; ++x) {
+			std::size_t i = y * side + x;
+			entries.push_back({i, i, 4 + weight * Real(i % 7)});
+			if (x > 0) entries.push_back({i, i - 1, -1});
+			if (x + 1 < side) entries.push_back({i, i + 1, -1});
+			if (y > 0) entries.push_back({i, i - side, -1});
+			if (y + 1 < side) entries.push_back({i, i + side, -1});
+		}
+	return SparseMatrix(side * side, side * side, entries);
+}
+
+Real residual(const SparseMatrix& mat, const std::vector<Real>& x, const std::vector<Real>& b) {
+	std::vector<Real> ax = mat * x;
+	Accumulator rr = 0, bb = 0;
+	for (std::size_t i = 0; i < b.size(); ++i) {
+		rr += (b[i] - ax[i]) * (b[i] - ax[i]);
+		bb += b[i] * b[i];
+	}
+	return Real(std::sqrt(rr / bb));
+}
+
+}
+
+TEST(ConjugateGradient, Small) {
+	SparseMatrix mat(3, 3, {{0, 0, 4}, {0, 1, 1}, {1, 0, 1}, {1, 1, 3}, {2, 2, 2}});
+	ConjugateGradient solver(mat);
+	std::vector<Real> x;
+	EXPECT_TRUE(solver.solve({1, 2, 4}, x));
+	EXPECT_NEAR(1.0 / 11, x[0], 4 * tolerance);
+	EXPECT_NEAR(7.0 / 11, x[1], 4 * tolerance);
+	EXPECT_NEAR(2, x[2], 4 * tolerance);
+	EXPECT_LE(solver.iterations(), 3u);
+
+	// The solution stays where it starts, and b = 0 gives x = 0
+	EXPECT_TRUE(solver.solve({1, 2, 4}, x));
+	EXPECT_EQ(0u, solver.iterations());
+	EXPECT_TRUE(solver.solve({0, 0, 0}, x));
+	EXPECT_EQ((std::vector<Real>{0, 0, 0}), x);
+
+	EXPECT_THROW(ConjugateGradient(SparseMatrix(2, 3, {})), std::logic_error);
+	EXPECT_THROW(solver.solve({1, 2}, x), std::logic_error);
+}
+
+TEST(ConjugateGradient, Grid) {
+	const std::size_t side = 200;
+	SparseMatrix mat = gridLaplacian(side, 100);
+	std::vector<Real> b(side * side);
+	for (std::size_t i = 0; i < b.size(); ++i)
+		b[i] = std::sin(Real(i));
+
+	ConjugateGradient solver(mat);
+	solver.setTolerance(tolerance);
+	std::vector<Real> x;
+	EXPECT_TRUE(solver.solve(b, x));
+	EXPECT_LE(solver.residual(), tolerance);
+	EXPECT_LE(residual(mat, x, b), 10 * tolerance);
+
+	// Same iterates whatever the number of threads
+	ThreadPool pool(4);
+	ConjugateGradient threaded(mat, &pool);
+	threaded.setTolerance(tolerance);
+	std::vector<Real> y;
+	EXPECT_TRUE(threaded.solve(b, y));
+	EXPECT_EQ(solver.iterations(), threaded.iterations());
+	EXPECT_EQ(x, y);
+}
+
+TEST(ConjugateGradient, MaxIterations) {
+	SparseMatrix mat = gridLaplacian(50);
+	ConjugateGradient solver(mat);
+	solver.setMaxIterations(5);
+	std::vector<Real> x;
+	EXPECT_FALSE(solver.solve(std::vector<Real>(2500, 1), x));
+	EXPECT_EQ(5u, solver.iterations());
+	EXPECT_GT(solver.residual(), solver.tolerance());
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <math/DenseMatrix>
+#include <math/ThreadPool>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+namespace {
+
+DenseMatrix randomMatrix(std::size_t rows, std::size_t cols, std::mt19937& random) {
+	std::uniform_real_distribution<Real> cell(-1, 1);
+	DenseMatrix mat(rows, cols);
+	for (std::size_t i = 0; i < rows; ++i)
+		for (std::size_t j = 0; j < cols; ++j)
+			mat(i, j) = cell(random);
+	return mat;
+}
+
+/// The product by the textbook loop, to check the blocked one
+DenseMatrix naiveProduct(const DenseMatrix& a, const DenseMatrix& b) {
+	DenseMatrix result(a.rows(), b.cols());
+	for (std::size_t i = 0; i < a.rows(); ++i)
+		for (std::size_t j = 0; j < b.cols(); ++j) {
+			Accumulator sum = 0;
+			for (std::size_t k = 0; k < a.cols(); ++k)
+				sum += a(i, k) * b(k, j);
+			result(i, j) = Real(sum);
+		}
+	return result;
+}
+
+}
+
+TEST(DenseMatrix, Operations) {
+	DenseMatrix a(2, 3);
+	EXPECT_EQ(2u, a.rows());
+	EXPECT_EQ(3u, a.cols());
+	EXPECT_EQ(0, a(1, 2));
+
+	for (std::size_t c = 0; c < 6; ++c)
+		a.data()[c] = Real(c + 1);
+	EXPECT_EQ(6, a(1, 2));
+	EXPECT_EQ(4, a(1, 0));
+
+	DenseMatrix t = a.transpost();
+	EXPECT_EQ(3u, t.rows());
+	EXPECT_EQ(4, t(0, 1));
+
+	DenseMatrix sum = a + a * 2 - a;
+	EXPECT_EQ(12, sum(1, 2));
+
+	DenseMatrix product = a * t;
+	EXPECT_EQ(14, product(0, 0));
+	EXPECT_EQ(32, product(0, 1));
+	EXPECT_EQ(77, product(1, 1));
+
+	std::vector<Real> y = a * std::vector<Real>{1, 0, -1};
+	EXPECT_EQ(-2, y[0]);
+	EXPECT_EQ(-2, y[1]);
+
+	DenseMatrix eye = DenseMatrix::eye(3);
+	DenseMatrix same = a * eye;
+	for (std::size_t c = 0; c < 6; ++c)
+		EXPECT_EQ(a.data()[c], same.data()[c]);
+
+	EXPECT_THROW(a * a, std::logic_error);
+	EXPECT_THROW(a + t, std::logic_error);
+	EXPECT_THROW(a * std::vector<Real>(2), std::logic_error);
+}
+
+TEST(DenseMatrix, BlockedProduct) {
+	std::mt19937 random(3);
+	// Sizes that leave partial blocks and partial SIMD registers
+	DenseMatrix a = randomMatrix(150, 263, random);
+	DenseMatrix b = randomMatrix(263, 131, random);
+	DenseMatrix expected = naiveProduct(a, b);
+
+	DenseMatrix product = a * b;
+	ThreadPool pool(4);
+	DenseMatrix threaded;
+	DenseMatrix::multiply(a, b, threaded, &pool);
+
+	ASSERT_EQ(150u, product.rows());
+	ASSERT_EQ(131u, product.cols());
+	for (std::size_t i = 0; i < product.rows(); ++i)
+		for (std::size_t j = 0; j < product.cols(); ++j) {
+			EXPECT_NEAR(expected(i, j), product(i, j), tolerance);
+			EXPECT_EQ(product(i, j), threaded(i, j));
+		}
+
+	// The result may be an operand
+	DenseMatrix square = randomMatrix(70, 70, random);
+	DenseMatrix squared = naiveProduct(square, square);
+	DenseMatrix::multiply(square, square, square, &pool);
+	for (std::size_t i = 0; i < 70; ++i)
+		for (std::size_t j = 0; j < 70; ++j)
+			EXPECT_NEAR(squared(i, j), square(i, j), tolerance);
+}
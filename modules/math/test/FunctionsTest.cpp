@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <math/Functions>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/Quaternion>
+#include <math/cte>
+#include <cmath>
+#include <limits>
+
+using namespace math;
+
+namespace {
+
+const unsigned count = 97;
+const Real epsilon = std::numeric_limits<Real>::epsilon();
+
+struct Table {
+	Real x[count];
+	Real sin[count];
+	Real cos[count];
+	Real sqrt[count];
+};
+
+// Filled during constant evaluation, so the results below come from the constexpr path
+constexpr Table makeTable() {
+	Table table{};
+	for (unsigned i = 0; i < count; ++i) {
+		Real x = (Real(i) - count / 2) * Real(0.37);
+		table.x[i] = x;
+		table.sin[i] = cmath::sin(x);
+		table.cos[i] = cmath::cos(x);
+		table.sqrt[i] = cmath::sqrt(x * x * x * x + x);
+	}
+	return table;
+}
+
+constexpr Table table = makeTable();
+
+}
+
+TEST(Functions, ConstantEvaluation) {
+	for (unsigned i = 0; i < count; ++i) {
+		Real x = table.x[i];
+		EXPECT_NEAR(std::sin(x), table.sin[i], 4 * epsilon) << x;
+		EXPECT_NEAR(std::cos(x), table.cos[i], 4 * epsilon) << x;
+
+		Real radicand = x * x * x * x + x;
+		if (radicand < 0) EXPECT_TRUE(std::isnan(table.sqrt[i]));
+		else EXPECT_NEAR(std::sqrt(radicand), table.sqrt[i], 2 * epsilon * std::sqrt(radicand)) << radicand;
+	}
+
+	// The extremes of the exponent range, which are even powers of two with exact roots
+	constexpr Real tiny = cmath::sqrt(std::numeric_limits<Real>::min());
+	constexpr Real huge = cmath::sqrt(1 / std::numeric_limits<Real>::min());
+	EXPECT_EQ(std::sqrt(std::numeric_limits<Real>::min()), tiny);
+	EXPECT_EQ(1 / tiny, huge);
+	static_assert(cmath::sqrt(Real(0)) == 0, "sqrt(0)");
+	static_assert(cmath::sqrt(Real(16)) == 4, "sqrt(16)");
+
+	// Angles with no bit left below a turn give NaN instead of converting out of the range of an integer
+	constexpr Real sinInfinity = cmath::sin(std::numeric_limits<Real>::infinity());
+	constexpr Real cosNaN = cmath::cos(std::numeric_limits<Real>::quiet_NaN());
+	constexpr Real sinHuge = cmath::sin(Real(1e30));
+	constexpr Real sinLarge = cmath::sin(Real(1000));
+	EXPECT_TRUE(std::isnan(sinInfinity));
+	EXPECT_TRUE(std::isnan(cosNaN));
+	EXPECT_TRUE(std::isnan(sinHuge));
+	EXPECT_NEAR(std::sin(Real(1000)), sinLarge, 1000 * epsilon);
+}
+
+TEST(Functions, RunTime) {
+	// Outside constant evaluation they are the <cmath> functions
+	for (Real x : {-3.0, 0.5, 2.0, 100.0}) {
+		EXPECT_EQ(std::sin(x), cmath::sin(x));
+		EXPECT_EQ(std::cos(x), cmath::cos(x));
+		EXPECT_EQ(std::sqrt(std::abs(x)), cmath::sqrt(std::abs(x)));
+	}
+}
+
+TEST(Functions, ConstexprGeometry) {
+	constexpr Vector3 v = {3, 4, 12};
+	static_assert(v.length() == 13, "length");
+	constexpr Vector3 u = v.unit();
+	EXPECT_EQ(Real(4.0 / 13), u.y());
+
+	// A rotor mount, a quarter turn arround z, folded into constants
+	constexpr Quaternion mount = Quaternion::rotationZ(cte::tau / 4);
+	constexpr Vector3 arm = mount.rotate({1, 0, 0});
+	constexpr Matrix3 rotation = mount.matrix();
+	EXPECT_NEAR(0, arm.x(), 4 * epsilon);
+	EXPECT_NEAR(1, arm.y(), 4 * epsilon);
+	EXPECT_NEAR(-1, rotation(0, 1), 4 * epsilon);
+
+	constexpr Quaternion back = Quaternion::fromMatrix(rotation);
+	EXPECT_NEAR(1, std::abs(back.dot(mount)), 4 * epsilon);
+}
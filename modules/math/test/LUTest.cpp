@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <math/LU>
+#include <math/Matrix>
+#include <math/Vector>
+#include <cmath>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+TEST(LU, Factors) {
+	Matrix3 mat = {1, 1, 1,   1, 2, 2,   2, 2, 1};
+	LU<3> lu(mat);
+	EXPECT_FALSE(lu.isSingular());
+	EXPECT_DOUBLE_EQ(-1, lu.det());
+
+	// P * A = L * U
+	Matrix3 l = Matrix3::eye();
+	Matrix3 u;
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			(j < i ? l(i, j) : u(i, j)) = lu.factors()(i, j);
+
+	Matrix3 product = l * u;
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			EXPECT_DOUBLE_EQ(mat(lu.permutation()[i], j), product(i, j));
+
+	// The largest cell of the first column is moved up
+	EXPECT_EQ(2u, lu.permutation()[0]);
+}
+
+TEST(LU, SolveMany) {
+	Matrix3 mat = {1, 1, 1,   1, 2, 2,   2, 2, 1};
+	LU<3> lu(mat);
+
+	Vector3 x;
+	EXPECT_TRUE(lu.solve({6, 11, 9}, x));
+	EXPECT_DOUBLE_EQ(1, x(0));
+	EXPECT_DOUBLE_EQ(2, x(1));
+	EXPECT_DOUBLE_EQ(3, x(2));
+
+	Matrix<3, 2> b = {6, 3,   11, 5,   9, 4};
+	Matrix<3, 2> xs;
+	EXPECT_TRUE(lu.solve(b, xs));
+	EXPECT_DOUBLE_EQ(1, xs(0, 0));
+	EXPECT_DOUBLE_EQ(2, xs(1, 0));
+	EXPECT_DOUBLE_EQ(3, xs(2, 0));
+	EXPECT_DOUBLE_EQ(1, xs(0, 1));
+	EXPECT_DOUBLE_EQ(0, xs(1, 1));
+	EXPECT_DOUBLE_EQ(2, xs(2, 1));
+
+	Matrix3 inverse;
+	EXPECT_TRUE(lu.inverse(inverse));
+	Matrix3 expected = {2, -1, 0,   -3, 1, 1,   2, 0, -1};
+	for (unsigned c = 0; c < 9; ++c)
+		EXPECT_DOUBLE_EQ(expected(c), inverse(c));
+}
+
+TEST(LU, Singular) {
+	LU<3> lu(Matrix3::ones());
+	EXPECT_TRUE(lu.isSingular());
+	EXPECT_EQ(0, lu.det());
+
+	Vector3 x = {7, 8, 9};
+	EXPECT_FALSE(lu.solve({1, 1, 1}, x));
+	EXPECT_DOUBLE_EQ(7, x(0));
+
+	Matrix3 inverse = Matrix3::eye();
+	EXPECT_FALSE(lu.inverse(inverse));
+	EXPECT_DOUBLE_EQ(1, inverse(0, 0));
+
+	// The zero column doesn't stop the other ones from being factored
+	Matrix3 mat = {0, 1, 2,   0, 3, 4,   0, 5, 7};
+	EXPECT_TRUE(LU<3>(mat).isSingular());
+	EXPECT_EQ(0, LU<3>(mat).det());
+}
+
+TEST(LU, BadlyScaled) {
+	// Without pivoting, the tiny first pivot makes the elimination lose the second equation
+	Matrix2 mat = {1e-20, 1,   1, 1};
+	Vector2 x;
+	EXPECT_TRUE(LU<2>(mat).solve({1, 2}, x));
+	EXPECT_DOUBLE_EQ(1, x(0));
+	EXPECT_DOUBLE_EQ(1, x(1));
+
+	// The same on a larger system, where the tiny pivot would spoil the lines below it
+	Matrix3 big = {1e-17, 1, 1,   1, 1, 0,   0, 1, 2};
+	Vector3 expected = {3, -2, 5};
+	Vector3 solved;
+	EXPECT_TRUE(big.solve(big * expected, solved));
+	for (unsigned i = 0; i < 3; ++i)
+		EXPECT_NEAR(expected(i), solved(i), tolerance);
+}
+
+TEST(LU, LargeMatrix) {
+	using Matrix6 = Matrix<6, 6>;
+
+	// A row swap of a product of triangular factors, whose determinant is known without any elimination
+	Matrix6 lower = Matrix6::eye(), upper, swap = Matrix6::eye();
+	Real det = -1;
+	for (unsigned i = 0; i < 6; ++i) {
+		for (unsigned j = 0; j < i; ++j)
+			lower(i, j) = std::cos(Real(i * 6 + j) * Real(0.9));
+		for (unsigned j = i + 1; j < 6; ++j)
+			upper(i, j) = std::sin(Real(i * 6 + j));
+		upper(i, i) = Real(i + 2);
+		det *= Real(i + 2);
+	}
+	swap(1, 1) = swap(4, 4) = 0;
+	swap(1, 4) = swap(4, 1) = 1;
+	Matrix6 mat = swap * lower * upper;
+
+	LU<6> lu(mat);
+	EXPECT_NEAR(det, lu.det(), std::abs(det) * tolerance);
+
+	Matrix6 product = mat * mat.inverse();
+	for (unsigned x = 0; x < 36; ++x)
+		EXPECT_NEAR(Matrix6::eye()(x), product(x), tolerance);
+}
@@ -2,6 +2,10 @@
 #include <math/Matrix>
 #include <math/Vector>
 #include <iostream>
+#include <cmath>
+#include <stdexcept>
+
+#include "Tolerance.hpp"
 
 using namespace math;
 
@@ -69,6 +73,33 @@ TEST_F(MatrixAlgebra3, Sum) {
 	EXPECT_DOUBLE_EQ(2, mat(2, 2));
 }
 
+TEST_F(MatrixAlgebra3, Expressions) {
+	Matrix3 mat = {1, 2, 3,   4, 5, 6,   7, 8, 10};
+
+	Matrix3 sum = mat;
+	sum = sum * 2 - (one + identity) / 2.0;
+	sum += identity;
+	sum -= -mat;
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_DOUBLE_EQ(3 * mat(x) - 0.5 * one(x) + 0.5 * identity(x), sum(x));
+
+	Matrix3 product = mat;
+	product *= one + identity;
+	Matrix3 expected = mat * (one + identity);
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_DOUBLE_EQ(expected(x), product(x));
+
+	// A matrix multiplied by itself in place
+	product = mat;
+	product *= product;
+	expected = mat * mat;
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_DOUBLE_EQ(expected(x), product(x));
+
+	EXPECT_DOUBLE_EQ(8 * mat.det(), (mat + mat).det());
+	EXPECT_DOUBLE_EQ(4, ((mat - mat) * Vector3(1, 1, 1) + Vector3(4, 0, 0)).x());
+}
+
 TEST_F(MatrixAlgebra3, Multiplication) {
 	Matrix3 mat = identity * one;
 	EXPECT_DOUBLE_EQ(1, mat(0, 0));
@@ -148,6 +179,140 @@ TEST_F(MatrixAlgebra3, Inverse) {
 	EXPECT_DOUBLE_EQ(-1, idiv(2, 2));
 }
 
+TEST_F(MatrixAlgebra3, TryInverse) {
+	Matrix3 other = {1, 1, 1,   1, 2, 2,   2, 2, 1};
+	Matrix3 idiv = null;
+	EXPECT_TRUE(other.tryInverse(idiv));
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_DOUBLE_EQ(other.inverse()(x), idiv(x));
+	
+	// Singular matrices leave the result untouched, and only inverse() throws
+	Matrix3 untouched = 2 * identity;
+	EXPECT_FALSE(one.tryInverse(untouched));
+	EXPECT_FALSE(null.tryInverse(untouched));
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_DOUBLE_EQ((2 * identity)(x), untouched(x));
+	EXPECT_THROW(one.inverse(), std::logic_error);
+}
+
+TEST_F(MatrixAlgebra3, Solve) {
+	Matrix3 other = {1, 1, 1,   1, 2, 2,   2, 2, 1};
+	Vector3 x;
+	EXPECT_TRUE(other.solve({6, 11, 9}, x));
+	EXPECT_DOUBLE_EQ(1, x(0));
+	EXPECT_DOUBLE_EQ(2, x(1));
+	EXPECT_DOUBLE_EQ(3, x(2));
+	
+	// A zero on the first pivot needs a line swap
+	Matrix3 swapped = {0, 1, 0,   1, 0, 0,   0, 0, 2};
+	EXPECT_TRUE(swapped.solve({4, 5, 6}, x));
+	EXPECT_DOUBLE_EQ(5, x(0));
+	EXPECT_DOUBLE_EQ(4, x(1));
+	EXPECT_DOUBLE_EQ(3, x(2));
+	
+	x = {7, 8, 9};
+	EXPECT_FALSE(one.solve({1, 1, 1}, x));
+	EXPECT_DOUBLE_EQ(7, x(0));
+	EXPECT_DOUBLE_EQ(8, x(1));
+	EXPECT_DOUBLE_EQ(9, x(2));
+}
+
+/// The determinant by cofactor expansion along the first line, for any size
+template <unsigned N>
+static Real expansionDet(const Matrix<N, N>& mat) {
+	if (N == 1) return mat(0, 0);
+	
+	Real result = 0;
+	for (unsigned k = 0; k < N; ++k) {
+		Matrix<(N > 1 ? N-1 : 1), (N > 1 ? N-1 : 1)> minor;
+		for (unsigned i = 1; i < N; ++i)
+			for (unsigned j = 0, jm = 0; j < N; ++j)
+				if (j != k) minor(i-1, jm++) = mat(i, j);
+		result += (k % 2 ? -1 : 1) * mat(0, k) * expansionDet(minor);
+	}
+	return result;
+}
+
+/// A well conditioned matrix with no particular structure, whose cells are of different magnitudes
+template <unsigned N>
+static Matrix<N, N> scrambled(unsigned seed) {
+	Matrix<N, N> mat = 2 * Matrix<N, N>::eye();
+	for (unsigned x = 0; x < N*N; ++x)
+		mat(x) += std::sin(seed * 1.7 + x * x * 0.61) * (1 + x % 3);
+	return mat;
+}
+
+template <unsigned N>
+static void expectClosedFormsMatchExpansion() {
+	using Square = Matrix<N, N>;
+	
+	for (unsigned seed = 1; seed < 20; ++seed) {
+		Square mat = scrambled<N>(seed);
+		EXPECT_NEAR(expansionDet(mat), mat.det(), tolerance);
+		
+		Square product = mat * mat.inverse();
+		for (unsigned x = 0; x < N*N; ++x)
+			EXPECT_NEAR(Square::eye()(x), product(x), tolerance);
+	}
+	
+	Square result = Square::eye();
+	EXPECT_EQ(0, Square::ones().det());
+	EXPECT_FALSE(Square::ones().tryInverse(result));
+	EXPECT_FALSE(Square::zeros().tryInverse(result));
+	EXPECT_EQ(1, result(0, 0));
+}
+
+TEST(MatrixAlgebra, ClosedForms) {
+	expectClosedFormsMatchExpansion<2>();
+	expectClosedFormsMatchExpansion<3>();
+	expectClosedFormsMatchExpansion<4>();
+	
+	// Sizes without closed formulas still use elimination
+	expectClosedFormsMatchExpansion<5>();
+	
+	Matrix2 two = {1, 2,   3, 4};
+	EXPECT_DOUBLE_EQ(-2, two.det());
+	Matrix2 twoInverse = two.inverse();
+	EXPECT_DOUBLE_EQ(-2, twoInverse(0, 0));
+	EXPECT_DOUBLE_EQ(1, twoInverse(0, 1));
+	EXPECT_DOUBLE_EQ(1.5, twoInverse(1, 0));
+	EXPECT_DOUBLE_EQ(-0.5, twoInverse(1, 1));
+}
+
+TEST(MatrixAlgebra, AffineInverse) {
+	// A rotation about z, a non-uniform scaling and a translation
+	Real c = std::cos(0.3), s = std::sin(0.3);
+	Matrix4 affine = {
+		2 * c, -3 * s, 0, 5,
+		2 * s,  3 * c, 0, -1,
+		0,      0,     4, 2,
+		0,      0,     0, 1
+	};
+	
+	Matrix4 expected = affine.inverse();
+	Matrix4 actual = affine.affineInverse();
+	for (unsigned x = 0; x < 16; ++x)
+		EXPECT_NEAR(expected(x), actual(x), tolerance);
+	
+	Matrix4 flat = affine;
+	flat(2, 2) = 0;
+	EXPECT_FALSE(flat.tryAffineInverse(actual));
+	EXPECT_THROW(flat.affineInverse(), std::logic_error);
+}
+
+TEST(MatrixAlgebra, ScalarTypes) {
+	using Matrix3f = Matrix<3, 3, float>;
+	Matrix3f mat = {2, 0, 0,   0, 4, 0,   1, 0, 1};
+	EXPECT_FLOAT_EQ(8, mat.det());
+
+	Matrix3f product = mat * mat.inverse();
+	for (unsigned x = 0; x < 9; ++x)
+		EXPECT_FLOAT_EQ(Matrix3f::eye()(x), product(x));
+
+	Matrix3 wide(mat);
+	EXPECT_DOUBLE_EQ(4, wide(1, 1));
+}
+
 TEST(MatrixAlgebra, Multiplication) {
 	Matrix<10, 8> mat = 2 * Matrix<10, 5>::ones() * Matrix<5, 8>::ones();
 	
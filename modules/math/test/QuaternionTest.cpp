@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <math/Quaternion>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/cte>
+#include <cmath>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+namespace {
+
+void expectNear(const Vector3& expected, const Vector3& actual) {
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(expected(c), actual(c), tolerance);
+}
+
+void expectSameRotation(const Quaternion& expected, const Quaternion& actual) {
+	// q and -q are the same rotation
+	EXPECT_NEAR(1, std::abs(expected.dot(actual)), tolerance);
+}
+
+}
+
+TEST(Quaternion, Rotate) {
+	Quaternion z = Quaternion::rotationZ(cte::tau / 4);
+	expectNear({0, 1, 0}, z.rotate({1, 0, 0}));
+	expectNear({-1, 0, 0}, z.rotate({0, 1, 0}));
+	expectNear({0, 0, 1}, z.rotate({0, 0, 1}));
+	
+	Quaternion x = Quaternion::rotationX(cte::tau / 4);
+	expectNear({0, 0, 1}, x.rotate({0, 1, 0}));
+	
+	Quaternion y = Quaternion::rotationY(cte::tau / 4);
+	expectNear({0, 0, -1}, y.rotate({1, 0, 0}));
+	
+	// A third of a turn arround the diagonal permutes the axes
+	Quaternion diagonal = Quaternion::axisAngle({1, 1, 1}, cte::tau / 3);
+	expectNear({0, 1, 0}, diagonal.rotate({1, 0, 0}));
+	expectNear({0, 0, 1}, diagonal.rotate({0, 1, 0}));
+}
+
+TEST(Quaternion, Compose) {
+	Quaternion a = Quaternion::axisAngle({1, 2, 3}, 0.7);
+	Quaternion b = Quaternion::axisAngle({-2, 0.5, 1}, 1.9);
+	Vector3 v = {0.3, -1.2, 2};
+	
+	expectNear(a.rotate(b.rotate(v)), (a * b).rotate(v));
+	expectNear(v, (a * a.conjugate()).rotate(v));
+	
+	Quaternion c = a;
+	c *= b;
+	expectSameRotation(a * b, c);
+	
+	Matrix3 product = a.matrix() * b.matrix();
+	expectNear(product * v, (a * b).matrix() * v);
+	expectNear(a.rotate(v), a.matrix() * v);
+}
+
+TEST(Quaternion, FromMatrix) {
+	// Angles near pi exercise the branches where w is not the largest component
+	Vector3 axes[] = {{1, 2, 3}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {-1, 0.1, 0.2}, {0.1, -1, 0.3}, {0.2, 0.1, -1}};
+	for (const Vector3& axis : axes) {
+		for (Real angle : {0.3, 2.0, 3.1}) {
+			Quaternion q = Quaternion::axisAngle(axis, angle);
+			expectSameRotation(q, Quaternion::fromMatrix(q.matrix()));
+		}
+	}
+}
+
+TEST(Quaternion, Normalize) {
+	Quaternion q(2, 0, 0, 0);
+	EXPECT_DOUBLE_EQ(2, q.norm());
+	EXPECT_DOUBLE_EQ(1, q.unit().norm());
+	
+	// Many compositions drift away from norm 1, normalize brings it back
+	Quaternion step = Quaternion::axisAngle({1, -1, 2}, 0.001);
+	Quaternion r;
+	for (int i = 0; i < 10000; ++i) r *= step;
+	r.normalize();
+	EXPECT_NEAR(1, r.norm(), 1e-15);
+	expectSameRotation(Quaternion::axisAngle({1, -1, 2}, 10), r);
+}
+
+TEST(Quaternion, Slerp) {
+	Quaternion a = Quaternion::rotationZ(0.2);
+	Quaternion b = Quaternion::rotationZ(1.4);
+	
+	expectSameRotation(a, Quaternion::slerp(a, b, 0));
+	expectSameRotation(b, Quaternion::slerp(a, b, 1));
+	expectSameRotation(Quaternion::rotationZ(0.5), Quaternion::slerp(a, b, 0.25));
+	
+	// -b is the same rotation as b, and slerp still takes the shortest arc
+	expectSameRotation(Quaternion::rotationZ(0.8), Quaternion::slerp(a, -b, 0.5));
+	
+	// Nearly equal rotations
+	Quaternion c = Quaternion::rotationZ(0.2 + 1e-9);
+	expectSameRotation(a, Quaternion::slerp(a, c, 0.5));
+}
+
+TEST(Quaternion, BatchedSlerp) {
+	const std::size_t count = 7;
+	Quaternion from[count], to[count], result[count];
+	Real t[count];
+	for (std::size_t i = 0; i < count; ++i) {
+		from[i] = Quaternion::axisAngle({Real(i), 1, -1}, 0.3 * i);
+		to[i] = Quaternion::axisAngle({1, Real(i), 2}, 3 - 0.5 * i);
+		t[i] = Real(i) / (count - 1);
+	}
+	
+	Quaternion::slerp(from, to, t, result, count);
+	for (std::size_t i = 0; i < count; ++i) {
+		expectSameRotation(Quaternion::slerp(from[i], to[i], t[i]), result[i]);
+		EXPECT_NEAR(1, result[i].norm(), tolerance);
+	}
+	
+	// In place
+	Quaternion::slerp(from, to, t, from, count);
+	for (std::size_t i = 0; i < count; ++i)
+		expectSameRotation(result[i], from[i]);
+}
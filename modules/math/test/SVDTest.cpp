@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <math/SVD>
+#include <math/Quaternion>
+#include <math/ThreadPool>
+#include <math/Vector>
+#include <math/Matrix>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+namespace {
+
+Matrix3 diagonal(const Vector3& values) {
+	Matrix3 d;
+	for (unsigned i = 0; i < 3; ++i)
+		d(i, i) = values(i);
+	return d;
+}
+
+void expectNear(const Matrix3& expected, const Matrix3& actual, Real bound) {
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			EXPECT_NEAR(expected(i, j), actual(i, j), bound);
+}
+
+/// Checks that the decomposition is sorted, orthogonal, and rebuilds mat
+void expectDecomposes(const Matrix3& mat, const Matrix3& u, const Vector3& s, const Matrix3& v) {
+	EXPECT_GE(s(0), s(1));
+	EXPECT_GE(s(1), s(2));
+	EXPECT_GE(s(2), 0);
+	expectNear(Matrix3::eye(), u.transpost() * u, tolerance);
+	expectNear(Matrix3::eye(), v.transpost() * v, tolerance);
+	EXPECT_NEAR(1, v.det(), tolerance);
+	expectNear(mat, u * diagonal(s) * v.transpost(), 8 * tolerance);
+}
+
+}
+
+TEST(SVD, Known) {
+	Matrix3 u = Quaternion::axisAngle({1, 0, 2}, 0.4).matrix();
+	Matrix3 v = Quaternion::axisAngle({-3, 1, 1}, 1.3).matrix();
+	Matrix3 mat = u * diagonal({2, 5, 0.5}) * v.transpost();
+	SVD svd(mat);
+	EXPECT_NEAR(5, svd.singularValues()(0), tolerance);
+	EXPECT_NEAR(2, svd.singularValues()(1), tolerance);
+	EXPECT_NEAR(0.5, svd.singularValues()(2), tolerance);
+	expectDecomposes(mat, svd.u(), svd.singularValues(), svd.v());
+	EXPECT_NEAR(1, svd.u().det(), tolerance);
+}
+
+TEST(SVD, Reflection) {
+	Matrix3 mat = Quaternion::axisAngle({1, 1, 0}, 0.9).matrix() * diagonal({1, -3, 2});
+	SVD svd(mat);
+	EXPECT_NEAR(3, svd.singularValues()(0), tolerance);
+	EXPECT_NEAR(2, svd.singularValues()(1), tolerance);
+	EXPECT_NEAR(1, svd.singularValues()(2), tolerance);
+	expectDecomposes(mat, svd.u(), svd.singularValues(), svd.v());
+	EXPECT_NEAR(-1, svd.u().det(), tolerance);
+}
+
+TEST(SVD, Singular) {
+	// Rank 1 and rank 2: U stays orthonormal even though A * V has null columns
+	Matrix3 rank1(1, 2, 3,
+	              2, 4, 6,
+	              -1, -2, -3);
+	SVD svd1(rank1);
+	EXPECT_NEAR(0, svd1.singularValues()(1), std::sqrt(tolerance));
+	EXPECT_NEAR(0, svd1.singularValues()(2), std::sqrt(tolerance));
+	expectDecomposes(rank1, svd1.u(), svd1.singularValues(), svd1.v());
+
+	Matrix3 rank2(1, 0, 1,
+	              0, 1, 1,
+	              1, 1, 2);
+	SVD svd2(rank2);
+	EXPECT_NEAR(0, svd2.singularValues()(2), std::sqrt(tolerance));
+	expectDecomposes(rank2, svd2.u(), svd2.singularValues(), svd2.v());
+
+	SVD null(Matrix3{});
+	EXPECT_EQ(Vector3(0, 0, 0), null.singularValues());
+	expectDecomposes(Matrix3{}, null.u(), null.singularValues(), null.v());
+}
+
+TEST(SVD, Batched) {
+	std::mt19937 random(11);
+	std::uniform_real_distribution<Real> cell(-10, 10);
+	const std::size_t count = 1001;
+	std::vector<Matrix3> matrices(count);
+	for (Matrix3& mat : matrices)
+		for (unsigned i = 0; i < 3; ++i)
+			for (unsigned j = 0; j < 3; ++j)
+				mat(i, j) = cell(random);
+
+	std::vector<Matrix3> u(count), v(count);
+	std::vector<Vector3> s(count);
+	ThreadPool pool(4);
+	SVD::decompose(matrices.data(), count, u.data(), s.data(), v.data(), &pool);
+
+	for (std::size_t k = 0; k < count; ++k) {
+		// Lanes may take one more sweep than a single matrix would, so only the last bits can differ
+		SVD single(matrices[k]);
+		for (unsigned i = 0; i < 3; ++i)
+			EXPECT_NEAR(single.singularValues()(i), s[k](i), tolerance);
+		expectDecomposes(matrices[k], u[k], s[k], v[k]);
+	}
+}
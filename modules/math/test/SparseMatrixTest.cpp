@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <math/SparseMatrix>
+#include <math/ThreadPool>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace math;
+
+TEST(SparseMatrix, Build) {
+	// Entries in any order, with a repeated cell
+	SparseMatrix mat(3, 4, {{2, 3, 5}, {0, 1, 2}, {2, 0, 1}, {0, 1, 1}, {1, 1, 4}});
+	EXPECT_EQ(3u, mat.rows());
+	EXPECT_EQ(4u, mat.cols());
+	EXPECT_EQ(4u, mat.nonZeros());
+
+	EXPECT_EQ(3, mat(0, 1));
+	EXPECT_EQ(4, mat(1, 1));
+	EXPECT_EQ(1, mat(2, 0));
+	EXPECT_EQ(5, mat(2, 3));
+	EXPECT_EQ(0, mat(0, 0));
+	EXPECT_EQ(0, mat(1, 3));
+
+	EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 4}), mat.rowStarts());
+	EXPECT_EQ((std::vector<std::size_t>{1, 1, 0, 3}), mat.columns());
+	EXPECT_EQ((std::vector<Real>{0, 4, 0}), mat.diagonal());
+
+	mat.at(1, 1) = 6;
+	EXPECT_EQ(6, mat(1, 1));
+	EXPECT_THROW(mat.at(1, 2), std::logic_error);
+	EXPECT_THROW(SparseMatrix(2, 2, {{2, 0, 1}}), std::logic_error);
+
+	std::vector<Real> y = mat * std::vector<Real>{1, 2, 3, 4};
+	EXPECT_EQ((std::vector<Real>{6, 12, 21}), y);
+	EXPECT_THROW(mat * std::vector<Real>(3), std::logic_error);
+}
+
+TEST(SparseMatrix, ThreadedProduct) {
+	std::mt19937 random(5);
+	std::uniform_real_distribution<Real> value(-1, 1);
+	std::uniform_int_distribution<std::size_t> col(0, 9999);
+
+	const std::size_t n = 20000;
+	std::vector<SparseMatrix::Entry> entries;
+	for (std::size_t i = 0; i < n; ++i)
+		for (unsigned k = 0; k < 7; ++k)
+			entries.push_back({i, col(random), value(random)});
+	SparseMatrix mat(n, 10000, entries);
+
+	std::vector<Real> x(10000);
+	for (Real& v : x)
+		v = value(random);
+
+	std::vector<Real> serial = mat * x;
+	std::vector<Real> threaded;
+	ThreadPool pool(4);
+	mat.multiply(x, threaded, &pool);
+	EXPECT_EQ(serial, threaded);
+
+	// Row by row from the stored cells
+	for (std::size_t i = 0; i < n; i += 997) {
+		Accumulator sum = 0;
+		for (std::size_t k = mat.rowStarts()[i]; k < mat.rowStarts()[i + 1]; ++k)
+			sum += mat.values()[k] * x[mat.columns()[k]];
+		EXPECT_DOUBLE_EQ(Real(sum), serial[i]);
+	}
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <math/SymmetricEigen>
+#include <math/Quaternion>
+#include <math/ThreadPool>
+#include <math/Vector>
+#include <math/Matrix>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+namespace {
+
+Matrix3 diagonal(const Vector3& values) {
+	Matrix3 d;
+	for (unsigned i = 0; i < 3; ++i)
+		d(i, i) = values(i);
+	return d;
+}
+
+void expectNear(const Matrix3& expected, const Matrix3& actual, Real bound) {
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			EXPECT_NEAR(expected(i, j), actual(i, j), bound);
+}
+
+/// Checks that the decomposition is sorted, a rotation, and rebuilds mat
+void expectDecomposes(const Matrix3& mat, const Vector3& values, const Matrix3& vectors) {
+	EXPECT_GE(values(0), values(1));
+	EXPECT_GE(values(1), values(2));
+	expectNear(Matrix3::eye(), vectors.transpost() * vectors, tolerance);
+	EXPECT_NEAR(1, vectors.det(), tolerance);
+	expectNear(mat, vectors * diagonal(values) * vectors.transpost(), tolerance);
+}
+
+Matrix3 randomSymmetric(std::mt19937& random) {
+	std::uniform_real_distribution<Real> cell(-10, 10);
+	Matrix3 mat;
+	for (unsigned i = 0; i < 3; ++i)
+		for (unsigned j = i; j < 3; ++j)
+			mat(i, j) = mat(j, i) = cell(random);
+	return mat;
+}
+
+}
+
+TEST(SymmetricEigen, Diagonal) {
+	SymmetricEigen3 eigen(diagonal({2, 5, -1}));
+	EXPECT_EQ(Vector3(5, 2, -1), eigen.values());
+	expectDecomposes(diagonal({2, 5, -1}), eigen.values(), eigen.vectors());
+	EXPECT_NEAR(1, std::abs(eigen.vectors()(1, 0)), tolerance);
+	EXPECT_NEAR(1, std::abs(eigen.vectors()(0, 1)), tolerance);
+}
+
+TEST(SymmetricEigen, PrincipalAxes) {
+	// An inertia tensor with known axes, turned away from the coordinate axes
+	Matrix3 rotation = Quaternion::axisAngle({1, 2, 3}, 0.7).matrix();
+	Matrix3 tensor = rotation * diagonal({3, 7, 1}) * rotation.transpost();
+	SymmetricEigen3 eigen(tensor);
+
+	EXPECT_NEAR(7, eigen.values()(0), tolerance);
+	EXPECT_NEAR(3, eigen.values()(1), tolerance);
+	EXPECT_NEAR(1, eigen.values()(2), tolerance);
+	expectDecomposes(tensor, eigen.values(), eigen.vectors());
+
+	// Each axis is the matching column of the rotation, up to its sign
+	const unsigned axes[3] = {1, 0, 2};
+	for (unsigned j = 0; j < 3; ++j) {
+		Real dot = 0;
+		for (unsigned i = 0; i < 3; ++i)
+			dot += eigen.vectors()(i, j) * rotation(i, axes[j]);
+		EXPECT_NEAR(1, std::abs(dot), tolerance);
+	}
+}
+
+TEST(SymmetricEigen, Repeated) {
+	// Any basis of the plane of a repeated eigenvalue will do, as long as it stays orthonormal
+	Matrix3 rotation = Quaternion::axisAngle({-1, 1, 2}, 2.1).matrix();
+	Matrix3 mat = rotation * diagonal({4, 4, -2}) * rotation.transpost();
+	SymmetricEigen3 eigen(mat);
+	EXPECT_NEAR(4, eigen.values()(0), tolerance);
+	EXPECT_NEAR(4, eigen.values()(1), tolerance);
+	EXPECT_NEAR(-2, eigen.values()(2), tolerance);
+	expectDecomposes(mat, eigen.values(), eigen.vectors());
+
+	SymmetricEigen3 scalar(diagonal({3, 3, 3}));
+	EXPECT_EQ(Vector3(3, 3, 3), scalar.values());
+	expectNear(Matrix3::eye(), scalar.vectors(), 0);
+
+	SymmetricEigen3 null(Matrix3{});
+	EXPECT_EQ(Vector3(0, 0, 0), null.values());
+	expectNear(Matrix3::eye(), null.vectors(), 0);
+}
+
+TEST(SymmetricEigen, Batched) {
+	std::mt19937 random(7);
+	// Not a multiple of any SIMD width, so the last register is partial
+	const std::size_t count = 1001;
+	std::vector<Matrix3> matrices(count);
+	for (Matrix3& mat : matrices)
+		mat = randomSymmetric(random);
+
+	std::vector<Vector3> values(count);
+	std::vector<Matrix3> vectors(count);
+	SymmetricEigen3::decompose(matrices.data(), count, values.data(), vectors.data());
+
+	ThreadPool pool(4);
+	std::vector<Vector3> threadedValues(count);
+	std::vector<Matrix3> threadedVectors(count);
+	SymmetricEigen3::decompose(matrices.data(), count, threadedValues.data(), threadedVectors.data(), &pool);
+
+	for (std::size_t k = 0; k < count; ++k) {
+		SymmetricEigen3 single(matrices[k]);
+		for (unsigned i = 0; i < 3; ++i)
+			EXPECT_NEAR(single.values()(i), values[k](i), tolerance);
+		expectDecomposes(matrices[k], values[k], vectors[k]);
+		EXPECT_EQ(values[k], threadedValues[k]);
+		expectNear(vectors[k], threadedVectors[k], 0);
+	}
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <math/ThreadPool>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace math;
+
+TEST(ThreadPool, Size) {
+	EXPECT_EQ(1u, ThreadPool(1).size());
+	EXPECT_EQ(3u, ThreadPool(3).size());
+	EXPECT_LE(1u, ThreadPool().size());
+}
+
+TEST(ThreadPool, CoversEveryElementOnce) {
+	ThreadPool pool(4);
+
+	// Several loops in a row, with counts around the grain
+	for (std::size_t count : {0, 1, 7, 64, 65, 1000, 100003}) {
+		std::vector<int> visits(count, 0);
+		pool.parallelFor(count, 64, [&](std::size_t begin, std::size_t end) {
+			EXPECT_LT(begin, end);
+			EXPECT_LE(end, count);
+			for (std::size_t i = begin; i < end; ++i)
+				++visits[i];
+		});
+
+		for (int v : visits)
+			ASSERT_EQ(1, v);
+	}
+}
+
+TEST(ThreadPool, UsesSeveralThreads) {
+	ThreadPool pool(4);
+	std::mutex mutex;
+	std::condition_variable arrived;
+	std::set<std::thread::id> ids;
+
+	// Each chunk waits for another thread to show up, so a single thread can't take them all
+	pool.parallelFor(pool.size(), 1, [&](std::size_t, std::size_t) {
+		std::unique_lock<std::mutex> lock(mutex);
+		ids.insert(std::this_thread::get_id());
+		arrived.notify_all();
+		arrived.wait_for(lock, std::chrono::seconds(10), [&] { return ids.size() > 1; });
+	});
+	EXPECT_LT(1u, ids.size());
+}
+
+TEST(ThreadPool, RethrowsFromBody) {
+	ThreadPool pool(4);
+	EXPECT_THROW(pool.parallelFor(10000, 10, [](std::size_t begin, std::size_t) {
+		if (begin == 5000) throw std::runtime_error("failed");
+	}), std::runtime_error);
+
+	// The pool still works afterwards
+	std::atomic<std::size_t> sum(0);
+	pool.parallelFor(100, 10, [&](std::size_t begin, std::size_t end) { sum += end - begin; });
+	EXPECT_EQ(100u, sum.load());
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <limits>
+
+#include <math/Real>
+
+/// Bound on the error of a few roundings on values of order one, at the precision of Real
+const math::Real tolerance = 4096 * std::numeric_limits<math::Real>::epsilon();
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <math/VectorArray>
+#include <math/Vector>
+#include <math/Matrix>
+#include <math/ThreadPool>
+#include <math/Simd>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Tolerance.hpp"
+
+using namespace math;
+
+namespace {
+
+// A size that is not a whole number of registers, so the kernels also go through their tails
+const std::size_t count = 11;
+
+std::vector<Vector3> sample(Real seed) {
+	std::vector<Vector3> vectors;
+	for (std::size_t i = 0; i < count; ++i)
+		vectors.push_back({std::sin(seed + i), std::cos(seed * 2 + i) * 3, Real(i) - 5});
+	return vectors;
+}
+
+void expectNear(const Vector3& expected, const Vector3& actual) {
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_NEAR(expected(c), actual(c), tolerance);
+}
+
+}
+
+TEST(VectorArray, Conversion) {
+	std::vector<Vector3> vectors = sample(1);
+	VectorArray<3> array(vectors);
+	ASSERT_EQ(count, array.size());
+	for (unsigned c = 0; c < 3; ++c)
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(array.component(c)) % 32);
+
+	std::vector<Vector3> back = array.toVectors();
+	for (std::size_t i = 0; i < count; ++i)
+		EXPECT_EQ(vectors[i], back[i]);
+
+	array.resize(3);
+	array.resize(5);
+	EXPECT_EQ(vectors[2], array.get(2));
+	EXPECT_EQ(Vector3(), array.get(4));
+}
+
+TEST(VectorArray, Arithmetic) {
+	std::vector<Vector3> a = sample(1), b = sample(2);
+	VectorArray<3> array(a), other(b);
+
+	array.add(other);
+	array.add(Vector3{1, 2, 3});
+	array.scale(0.5);
+	for (std::size_t i = 0; i < count; ++i)
+		expectNear((a[i] + b[i] + Vector3{1, 2, 3}) * 0.5, array.get(i));
+
+	EXPECT_THROW(array.add(VectorArray<3>(2)), std::logic_error);
+}
+
+TEST(VectorArray, Padding) {
+	VectorArray<3> array(sample(1));
+	array.add(Vector3{1, 2, 3});
+	Matrix<3, 4> affine = {1, 0, 0, 4,   0, 2, 0, 5,   0, 0, 1, 6};
+	array.transformPoints(affine, array);
+
+	// The rest of the last register is still zero, even though the translation and offset aren't
+	std::size_t registers = (count + simd::width - 1) / simd::width;
+	for (unsigned c = 0; c < 3; ++c)
+		for (std::size_t i = count; i < registers * simd::width; ++i)
+			EXPECT_EQ(0, array.component(c)[i]);
+}
+
+TEST(VectorArray, Products) {
+	std::vector<Vector3> a = sample(1), b = sample(2);
+	VectorArray<3> array(a), other(b);
+	Vector3 axis = {0.3, -2, 1.5};
+
+	std::vector<Real> dots(count), pairDots(count), lengths(count);
+	array.dot(axis, dots.data());
+	array.dot(other, pairDots.data());
+	array.lengths(lengths.data());
+
+	VectorArray<3> crosses;
+	array.cross(other, crosses);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		EXPECT_NEAR(a[i].dot(axis), dots[i], tolerance);
+		EXPECT_NEAR(a[i].dot(b[i]), pairDots[i], tolerance);
+		EXPECT_NEAR(a[i].length(), lengths[i], tolerance);
+		expectNear(a[i].cross(b[i]), crosses.get(i));
+	}
+}
+
+TEST(VectorArray, Normalize) {
+	std::vector<Vector3> a = sample(1);
+	a[3] = Vector3();
+	VectorArray<3> array(a);
+	array.normalize();
+
+	for (std::size_t i = 0; i < count; ++i) {
+		if (i == 3)
+			EXPECT_EQ(Vector3(), array.get(i));
+		else
+			expectNear(a[i].unit(), array.get(i));
+	}
+}
+
+TEST(VectorArray, Bounds) {
+	std::vector<Vector3> a = sample(1);
+	VectorArray<3> array(a);
+
+	Vector3 low = a[0], high = a[0];
+	for (const Vector3& vec : a)
+		for (unsigned c = 0; c < 3; ++c) {
+			low(c) = std::min(low(c), vec(c));
+			high(c) = std::max(high(c), vec(c));
+		}
+
+	EXPECT_EQ(low, array.min());
+	EXPECT_EQ(high, array.max());
+	EXPECT_TRUE(std::isinf(VectorArray<3>().min().x()));
+}
+
+TEST(VectorArray, Transform) {
+	std::vector<Vector3> a = sample(1);
+	VectorArray<3> array(a);
+
+	Matrix<2, 3> projection = {1, 2, 3,   -1, 0, 4};
+	VectorArray<2> projected;
+	array.multiply(projection, projected);
+
+	Matrix4 affine = {0, -1, 0, 5,   1, 0, 0, -2,   0, 0, 2, 1,   0, 0, 0, 1};
+	VectorArray<3> points, directions;
+	array.transformPoints(affine, points);
+	array.transformVectors(affine, directions);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		Vector2 expected = projection * a[i];
+		EXPECT_NEAR(expected.x(), projected.get(i).x(), tolerance);
+		EXPECT_NEAR(expected.y(), projected.get(i).y(), tolerance);
+
+		Vector4 point = affine * Vector4(a[i], 1);
+		Vector4 direction = affine * Vector4(a[i], 0);
+		expectNear({point.x(), point.y(), point.z()}, points.get(i));
+		expectNear({direction.x(), direction.y(), direction.z()}, directions.get(i));
+	}
+
+	// In place
+	array.transformPoints(affine, array);
+	for (std::size_t i = 0; i < count; ++i)
+		expectNear(points.get(i), array.get(i));
+}
+
+TEST(VectorArray, TransformAffineAndNormals) {
+	std::vector<Vector3> a = sample(2);
+	VectorArray<3> array(a);
+
+	Matrix<3, 4> affine = {0, -1, 0, 5,   1, 0, 0, -2,   0, 0, 2, 1};
+	Matrix4 homogeneous = {0, -1, 0, 5,   1, 0, 0, -2,   0, 0, 2, 1,   0, 0, 0, 1};
+	VectorArray<3> points, expectedPoints, directions, expectedDirections;
+	array.transformPoints(affine, points);
+	array.transformPoints(homogeneous, expectedPoints);
+	array.transformVectors(affine, directions);
+	array.transformVectors(homogeneous, expectedDirections);
+
+	// Normals stay perpendicular to the vectors they were perpendicular to
+	Matrix3 linear = {0, -1, 0,   1, 0, 0,   0, 0, 2};
+	VectorArray<3> normals;
+	array.transformNormals(linear, normals);
+
+	for (std::size_t i = 0; i < count; ++i) {
+		expectNear(expectedPoints.get(i), points.get(i));
+		expectNear(expectedDirections.get(i), directions.get(i));
+
+		Vector3 tangent = a[i].cross({0, 0, 1});
+		EXPECT_NEAR(0, normals.get(i).dot(linear * tangent), tolerance);
+		EXPECT_NEAR(1, normals.get(i).length(), tolerance);
+	}
+
+	EXPECT_THROW(array.transformNormals(Matrix3(), normals), std::logic_error);
+}
+
+TEST(VectorArray, TransformThreaded) {
+	// Enough vectors to be split between the threads
+	std::vector<Vector3> a;
+	for (std::size_t i = 0; i < 5000; ++i)
+		a.push_back({std::sin(Real(i)), std::cos(Real(i) * 3), Real(i) / 100});
+	VectorArray<3> array(a);
+
+	Matrix<3, 4> affine = {1, 2, 0, 5,   0, 1, 3, -2,   -1, 0, 2, 1};
+	VectorArray<3> single;
+	array.transformPoints(affine, single);
+
+	ThreadPool pool(4);
+	array.transformPoints(affine, array, &pool);
+	for (std::size_t i = 0; i < a.size(); ++i)
+		EXPECT_EQ(single.get(i), array.get(i));
+}
@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <math/Vector>
+#include <cmath>
+#include <limits>
 
+using math::Real;
 using math::Vector3;
 
 TEST(Vector, LengthComputation) {
@@ -73,3 +76,124 @@ TEST_F(VectorAlgebra, Multiply) {
 	EXPECT_DOUBLE_EQ(-3, a.y());
 	EXPECT_DOUBLE_EQ(-5, a.z());
 }
+
+TEST_F(VectorAlgebra, ScaleInPlace) {
+	Vector3 a = 2*i - 3*j + 5*k;
+	a *= 2;
+	EXPECT_DOUBLE_EQ(4, a.x());
+	EXPECT_DOUBLE_EQ(-6, a.y());
+	EXPECT_DOUBLE_EQ(10, a.z());
+
+	a /= 4;
+	EXPECT_DOUBLE_EQ(1, a.x());
+	EXPECT_DOUBLE_EQ(-1.5, a.y());
+	EXPECT_DOUBLE_EQ(2.5, a.z());
+}
+
+TEST_F(VectorAlgebra, Expressions) {
+	Vector3 a = 2*i - 3*j + 5*k;
+	Vector3 b = {0.5, 4, -1};
+
+	// Operands may be the vector assigned to
+	Vector3 c = a;
+	c = b - c * 2 + (c + b) / 2.0;
+	EXPECT_EQ(Vector3(-2.25, 10.5, -9), c);
+
+	c = a;
+	c += c;
+	c -= b * b;
+	c /= Vector3(1, 2, 4);
+	EXPECT_EQ(Vector3(3.75, -11, 2.25), c);
+
+	// Members that are not element-wise work on expressions too
+	EXPECT_DOUBLE_EQ(2.5, (a + b).x());
+	EXPECT_DOUBLE_EQ(a.dot(b) + b.dot(b), (a + b).dot(b));
+	EXPECT_EQ(a.cross(b) - b.cross(b), (a - b).cross(b));
+	EXPECT_TRUE(a + b == b + a);
+	EXPECT_EQ(math::Vector4(2.5, 1, 4, 1), math::Vector4(a + b, 1));
+}
+
+TEST(Vector, ExtendingConstructor) {
+	Vector3 a = {1, 2, 3};
+	math::Vector4 b(a, 4);
+	EXPECT_DOUBLE_EQ(3, b.z());
+	EXPECT_DOUBLE_EQ(4, b.t());
+
+	math::Vector<6> c(a, 4, 5, 6);
+	for (unsigned n = 0; n < 6; ++n)
+		EXPECT_DOUBLE_EQ(n + 1, c(n));
+}
+
+TEST(Vector, ProductsAndUnit) {
+	Vector3 a = {1, 2, 3};
+	Vector3 b = {-4, 0.5, 2};
+	EXPECT_DOUBLE_EQ(3, a.dot(b));
+	EXPECT_DOUBLE_EQ(14, a.dotself());
+
+	Vector3 c = a.cross(b);
+	EXPECT_DOUBLE_EQ(2.5, c.x());
+	EXPECT_DOUBLE_EQ(-14, c.y());
+	EXPECT_DOUBLE_EQ(8.5, c.z());
+	EXPECT_DOUBLE_EQ(0, c.dot(a));
+
+	Vector3 u = b.unit();
+	EXPECT_DOUBLE_EQ(1, u.length());
+	EXPECT_DOUBLE_EQ(b.x() / b.length(), u.x());
+
+	math::Vector4 d = {1, -2, 2, 4};
+	EXPECT_DOUBLE_EQ(5, d.length());
+	EXPECT_NEAR(0.8, d.unit().t(), std::numeric_limits<Real>::epsilon());
+}
+
+TEST(Vector, Padding) {
+	// Operations that would turn a zero padding into NaN or infinity must not leak into products
+	Vector3 a = {1, 2, 3};
+	Vector3 b = {4, 5, 6};
+	Vector3 scaled = a * std::numeric_limits<Real>::infinity();
+	EXPECT_TRUE(std::isinf(scaled.x()));
+	EXPECT_FALSE(scaled.isNan());
+
+	Vector3 divided = a / b;
+	EXPECT_DOUBLE_EQ(32, (divided * b).dot(b));
+	EXPECT_DOUBLE_EQ(32, (-a).dot(-b));
+}
+
+TEST(Vector, ScalarTypes) {
+	using Vector3f = math::Vector<3, float>;
+	Vector3f a = {1, 2, 3};
+	Vector3f b = a * 2 - Vector3f(0.5f, 0, 0);
+	EXPECT_FLOAT_EQ(1.5f, b.x());
+	EXPECT_FLOAT_EQ(14, a.dot(a));
+
+	// Only Real vectors are padded for SIMD
+	EXPECT_EQ(3 * sizeof(float), sizeof(Vector3f));
+
+	Vector3 wide(b);
+	EXPECT_DOUBLE_EQ(1.5, wide.x());
+	EXPECT_EQ(b, Vector3f(wide));
+}
+
+/// Runs every element-wise operation on scalars and on packs, which must agree to the last bit
+template <typename Op>
+static void expectSameOperation(const Real* a, const Real* b) {
+	Real packed[4];
+	for (unsigned p = 0; p < 4; p += math::simd::width)
+		math::simd::store(packed + p, Op::apply(math::simd::load(a + p), math::simd::load(b + p)));
+	for (unsigned n = 0; n < 4; ++n)
+		EXPECT_EQ(Op::apply(a[n], b[n]), packed[n]);
+}
+
+TEST(Vector, ScalarAndSimdKernels) {
+	Real a[4] = {1.5, -2.25, 1e-3, 7};
+	Real b[4] = {-0.5, 3, 1e5, 0.1};
+
+	expectSameOperation<math::internal::Add>(a, b);
+	expectSameOperation<math::internal::Subtract>(a, b);
+	expectSameOperation<math::internal::Multiply>(a, b);
+	expectSameOperation<math::internal::Divide>(a, b);
+
+	// Only the order of the sum may differ with 4 components, not with 3 and a zero padding
+	EXPECT_NEAR(math::internal::ScalarKernels<4>::dot(a, b), math::internal::SimdKernels<4>::dot(a, b), 1e-12);
+	a[3] = 0;
+	EXPECT_EQ(math::internal::ScalarKernels<4>::dot(a, b), math::internal::SimdKernels<4>::dot(a, b));
+}